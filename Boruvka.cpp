@@ -1,71 +1,159 @@
 #include "Boruvka.hpp"
+#include "edge_list.hpp"
+#include "parallel.hpp"
+#include "simd_kernels.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
 #include <limits>
+#include <memory>
 
-std::vector<std::tuple<int, int, int>> BoruvkaMST::computeMST(Graph& graph) {
-    // Implementation of Borůvka's MST algorithm
-    int V = graph.V;
-    std::vector<int> parent(V), rank(V, 0);
-    std::vector<int> cheapest(V, -1);
+namespace {
+
+const std::uint64_t NO_EDGE = std::numeric_limits<std::uint64_t>::max();
+
+}  // namespace
+
+BoruvkaMST::BoruvkaMST(unsigned numThreads, bool verbose, const CancelToken* cancel)
+    : numThreads(numThreads > 0 ? numThreads : 1), verbose(verbose), cancel(cancel) {}
+
+// Borůvka's algorithm over a contracted edge array. Each round every component picks its
+// cheapest outgoing edge (lock-free atomic min), components hook onto the chosen neighbor,
+// pointer jumping flattens the hooks, and the edge array is relabelled and contracted.
+std::vector<std::tuple<int, int, int>> BoruvkaMST::computeMST(const Graph& graph) {
+    const EdgeList edges = EdgeList::fromGraph(graph);
     std::vector<std::tuple<int, int, int>> mstEdges;
-    
-    // Initially each vertex is its own component
-    for (int i = 0; i < V; ++i) parent[i] = i;
-
-    int numComponents = V;
-    
-    while (numComponents > 1) {
-        std::fill(cheapest.begin(), cheapest.end(), -1);
-        
-        for (auto& edge : graph.getEdges()) {
-            int weight, u, v;
-            std::tie(weight, u, v) = edge;
-
-            int setU = findSet(parent, u);
-            int setV = findSet(parent, v);
-
-            if (setU != setV) {
-                if (cheapest[setU] == -1 || std::get<0>(graph.getEdges()[cheapest[setU]]) > weight)
-                    cheapest[setU] = &edge - &graph.getEdges()[0];
-
-                if (cheapest[setV] == -1 || std::get<0>(graph.getEdges()[cheapest[setV]]) > weight)
-                    cheapest[setV] = &edge - &graph.getEdges()[0];
-            }
-        }
 
-        for (int i = 0; i < V; ++i) {
-            if (cheapest[i] != -1) {
-                int weight, u, v;
-                std::tie(weight, u, v) = graph.getEdges()[cheapest[i]];
+    // Current round's edges as (component, component, original edge index)
+    std::vector<int> eu, ev;
+    std::vector<std::uint32_t> origin;
+    eu.reserve(edges.size());
+    ev.reserve(edges.size());
+    origin.reserve(edges.size());
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        if (edges.u[i] == edges.v[i]) continue;  // Self-loops never join components
+        eu.push_back(edges.u[i]);
+        ev.push_back(edges.v[i]);
+        origin.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    int numComponents = graph.V;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> cheapest(new std::atomic<std::uint64_t>[numComponents > 0 ? numComponents : 1]);
+    std::vector<int> hook(numComponents), root(numComponents), newId(numComponents);
+    long long totalWeight = 0;
 
-                int setU = findSet(parent, u);
-                int setV = findSet(parent, v);
+    while (!eu.empty() && !CancelToken::check(cancel)) {
+        const std::size_t m = eu.size();
+        const unsigned edgeChunks = chunkCount(m, numThreads);
+        const unsigned compChunks = chunkCount(numComponents, numThreads);
 
-                if (setU != setV) {
-                    mstEdges.push_back(std::make_tuple(weight, u, v));
-                    unionSets(parent, rank, setU, setV);
-                    numComponents--;
+        parallelChunks(numComponents, compChunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+            for (std::size_t c = lo; c < hi; ++c) cheapest[c].store(NO_EDGE, std::memory_order_relaxed);
+        });
+
+        // Cheapest outgoing edge of every component, keyed by (weight, position) so every
+        // component agrees on a strict total order
+        parallelChunks(m, edgeChunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+            for (std::size_t block = lo; block < hi; block += CancelToken::CHECK_INTERVAL) {
+                if (CancelToken::check(cancel)) return;
+                Simd::lowerCheapest(edges.weight.data(), origin.data(), eu.data(), ev.data(), block,
+                                    std::min(hi, block + CancelToken::CHECK_INTERVAL), cheapest.get());
+            }
+        });
+
+        if (CancelToken::check(cancel)) break;  // The scan may have stopped short
+
+        // Hook each component onto the other endpoint of its cheapest edge
+        parallelChunks(numComponents, compChunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+            for (std::size_t c = lo; c < hi; ++c) {
+                std::uint64_t key = cheapest[c].load(std::memory_order_relaxed);
+                if (key == NO_EDGE) {
+                    hook[c] = static_cast<int>(c);
+                    continue;
                 }
+                std::size_t pos = static_cast<std::uint32_t>(key);
+                hook[c] = eu[pos] == static_cast<int>(c) ? ev[pos] : eu[pos];
             }
+        });
+
+        // Mutual pairs picked the same edge; the smaller id becomes the root
+        parallelChunks(numComponents, compChunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+            for (std::size_t c = lo; c < hi; ++c) {
+                int target = hook[c];
+                bool mutual = hook[target] == static_cast<int>(c);
+                root[c] = (mutual && static_cast<int>(c) < target) ? static_cast<int>(c) : target;
+            }
+        });
+
+        // Every non-root component contributes its chosen edge exactly once
+        for (int c = 0; c < numComponents; ++c) {
+            if (root[c] == c) continue;
+            std::size_t pos = static_cast<std::uint32_t>(cheapest[c].load(std::memory_order_relaxed));
+            auto edge = edges.tuple(origin[pos]);
+            mstEdges.push_back(edge);
+            totalWeight += std::get<0>(edge);
+
+            // Print the selected edge
+            if (verbose) std::cout << "Boruvka: Edge: " << std::get<1>(edge) << " -- " << std::get<2>(edge)
+                                   << " (weight: " << std::get<0>(edge) << ")\n";
         }
-    }
-    return mstEdges;
-}
 
-int BoruvkaMST::findSet(std::vector<int>& parent, int i) {
-    if (parent[i] == i) return i;
-    return parent[i] = findSet(parent, parent[i]);
-}
+        // Pointer jumping until every component points straight at its root
+        std::atomic<bool> changed(true);
+        while (changed.load()) {
+            changed.store(false);
+            parallelChunks(numComponents, compChunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+                bool local = false;
+                for (std::size_t c = lo; c < hi; ++c) {
+                    int grand = root[root[c]];
+                    if (grand != root[c]) {
+                        hook[c] = grand;
+                        local = true;
+                    } else {
+                        hook[c] = root[c];
+                    }
+                }
+                if (local) changed.store(true, std::memory_order_relaxed);
+            });
+            root.swap(hook);
+        }
 
-void BoruvkaMST::unionSets(std::vector<int>& parent, std::vector<int>& rank, int u, int v) {
-    int setU = findSet(parent, u);
-    int setV = findSet(parent, v);
-    if (rank[setU] > rank[setV]) {
-        parent[setV] = setU;
-    } else if (rank[setU] < rank[setV]) {
-        parent[setU] = setV;
-    } else {
-        parent[setV] = setU;
-        rank[setU]++;
+        // Relabel the surviving roots densely
+        int next = 0;
+        for (int c = 0; c < numComponents; ++c) {
+            if (root[c] == c) newId[c] = next++;
+        }
+        if (next == numComponents) break;  // No component found an outgoing edge
+
+        // Contract: relabel every edge and drop the ones that became internal
+        std::vector<std::vector<int>> keptU(edgeChunks), keptV(edgeChunks);
+        std::vector<std::vector<std::uint32_t>> keptOrigin(edgeChunks);
+        parallelChunks(m, edgeChunks, [&](unsigned chunk, std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                int a = newId[root[eu[i]]];
+                int b = newId[root[ev[i]]];
+                if (a == b) continue;
+                keptU[chunk].push_back(a);
+                keptV[chunk].push_back(b);
+                keptOrigin[chunk].push_back(origin[i]);
+            }
+        });
+
+        std::vector<std::size_t> offsets(edgeChunks + 1, 0);
+        for (unsigned c = 0; c < edgeChunks; ++c) offsets[c + 1] = offsets[c] + keptU[c].size();
+        eu.resize(offsets[edgeChunks]);
+        ev.resize(offsets[edgeChunks]);
+        origin.resize(offsets[edgeChunks]);
+        parallelChunks(edgeChunks, edgeChunks, [&](unsigned chunk, std::size_t, std::size_t) {
+            std::copy(keptU[chunk].begin(), keptU[chunk].end(), eu.begin() + offsets[chunk]);
+            std::copy(keptV[chunk].begin(), keptV[chunk].end(), ev.begin() + offsets[chunk]);
+            std::copy(keptOrigin[chunk].begin(), keptOrigin[chunk].end(), origin.begin() + offsets[chunk]);
+        });
+
+        numComponents = next;
     }
+
+    if (verbose) std::cout << "Boruvka's Total Weight: " << totalWeight << std::endl;
+    return mstEdges;
 }
@@ -2,16 +2,20 @@
 #define BORUVKA_HPP
 
 #include "graph.hpp"
+#include "cancel_token.hpp"
 #include <vector>
 #include <tuple>
 
 class BoruvkaMST {
 public:
-    std::vector<std::tuple<int, int, int>> computeMST(Graph& graph);
+    explicit BoruvkaMST(unsigned numThreads = 1, bool verbose = true, const CancelToken* cancel = nullptr);
+
+    std::vector<std::tuple<int, int, int>> computeMST(const Graph& graph);
 
 private:
-    int findSet(std::vector<int>& parent, int i);
-    void unionSets(std::vector<int>& parent, std::vector<int>& rank, int u, int v);
+    unsigned numThreads;
+    bool verbose;  // Print every selected edge and the total weight
+    const CancelToken* cancel;  // Polled before every round and inside the edge scans
 };
 
 #endif  // BORUVKA_HPP
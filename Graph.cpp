@@ -1,26 +1,115 @@
 #include "graph.hpp"
+#include "shortest_path.hpp"
+#include "kruskal.hpp"
+#include "parallel.hpp"
 #include <algorithm>
 #include <numeric>
 #include <limits>
 #include <iostream>
-#include <queue>
-#include <functional>
+#include <atomic>
+#include <stdexcept>
+#include <string>
 
+// The overlay is folded into the CSR arrays once it holds this many entries
+// or a quarter of the base, whichever is larger, so compaction stays amortized O(1)
+static const std::size_t MIN_COMPACT_THRESHOLD = 1024;
+
+static std::atomic<int> vertexCountLimit{Graph::DEFAULT_VERTEX_LIMIT};
+
+int Graph::vertexLimit() { return vertexCountLimit.load(std::memory_order_relaxed); }
+
+void Graph::setVertexLimit(int limit) { vertexCountLimit.store(std::max(limit, 1), std::memory_order_relaxed); }
+
+// Checked before anything is sized by V
+static int checkedVertexCount(int V) {
+    if (V < 0 || V > Graph::vertexLimit()) {
+        throw std::length_error("vertex count " + std::to_string(V) + " outside 0.." + std::to_string(Graph::vertexLimit()));
+    }
+    return V;
+}
 
 // Constructor
-Graph::Graph(int V) : V(V), adjMatrix(V, std::vector<int>(V, -1)) {}
+Graph::Graph(int V) : V(checkedVertexCount(V)), csrOffsets(std::size_t(V) + 1, 0), mst(V) {}
+
+void Graph::appendOverlay(int u, int v, int weight) {
+    overlay[u].push_back({v, weight});
+    ++overlayEntries;
+}
+
+// Widen the weight bounds to cover weight; the first weight ever added sets both
+void Graph::noteWeight(int weight) {
+    if (!weighted) {
+        maxEdgeWeight = minEdgeWeight = weight;
+        weighted = true;
+        return;
+    }
+    maxEdgeWeight = std::max(maxEdgeWeight, weight);
+    minEdgeWeight = std::min(minEdgeWeight, weight);
+}
 
-// Add an edge to the adjacency matrix and mstEdges
+// Add an edge to the adjacency overlay and the edge list
 void Graph::addEdge(int u, int v, int weight) {
+    if (!isValidVertex(u) || !isValidVertex(v)) return;
+
     mstEdges.push_back({weight, u, v});
-    adjMatrix[u][v] = weight;
-    adjMatrix[v][u] = weight;  // Assuming an undirected graph
+    noteWeight(weight);
+    appendOverlay(u, v, weight);
+    if (u != v) appendOverlay(v, u, weight);  // Assuming an undirected graph
+    compactIfNeeded();
+    mst.onEdgeAdded(*this, u, v, weight);
+}
+
+// Bulk insert of packed (u, v, weight) triples. Small batches go through the overlay; large
+// ones are merged straight into a rebuilt CSR. Either way the MST is rebuilt on next query.
+void Graph::addEdges(const int* triples, std::size_t count) {
+    std::size_t before = mstEdges.size();
+    mstEdges.reserve(before + count);
+    for (std::size_t i = 0; i < count; ++i) {
+        int u = triples[3 * i], v = triples[3 * i + 1], weight = triples[3 * i + 2];
+        if (!isValidVertex(u) || !isValidVertex(v)) continue;
+        mstEdges.push_back({weight, u, v});
+        noteWeight(weight);
+    }
+    std::size_t added = mstEdges.size() - before;
+    if (added == 0) return;
+
+    if (added < MIN_COMPACT_THRESHOLD) {
+        for (std::size_t i = before; i < mstEdges.size(); ++i) {
+            int weight = std::get<0>(mstEdges[i]), u = std::get<1>(mstEdges[i]), v = std::get<2>(mstEdges[i]);
+            appendOverlay(u, v, weight);
+            if (u != v) appendOverlay(v, u, weight);
+        }
+        compactIfNeeded();
+    } else {
+        rebuildCSR(before);
+    }
+    mst.invalidate();
 }
 
-// Remove an edge from the adjacency matrix and mstEdges
+// Remove an edge from the adjacency store and the edge list
 void Graph::removeEdge(int u, int v) {
-    adjMatrix[u][v] = -1;
-    adjMatrix[v][u] = -1;  // Assuming an undirected graph
+    if (!isValidVertex(u) || !isValidVertex(v)) return;
+
+    // Tombstone the CSR slots and drop overlay entries on both endpoints
+    auto detach = [this](int from, int to) {
+        for (std::size_t i = csrOffsets[from]; i < csrOffsets[from + 1]; ++i) {
+            if (csrNeighbors[i] == to) {
+                csrNeighbors[i] = -1;
+                ++tombstones;
+            }
+        }
+        auto it = overlay.find(from);
+        if (it == overlay.end()) return;
+        auto& entries = it->second;
+        std::size_t before = entries.size();
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                      [to](const std::pair<int, int>& entry) { return entry.first == to; }),
+                      entries.end());
+        overlayEntries -= before - entries.size();
+        if (entries.empty()) overlay.erase(it);
+    };
+    detach(u, v);
+    if (u != v) detach(v, u);  // Assuming an undirected graph
 
     // Remove from mstEdges if present
     mstEdges.erase(std::remove_if(mstEdges.begin(), mstEdges.end(), 
@@ -28,115 +117,177 @@ void Graph::removeEdge(int u, int v) {
                       return (std::get<1>(edge) == u && std::get<2>(edge) == v) || 
                              (std::get<1>(edge) == v && std::get<2>(edge) == u);
                   }), mstEdges.end());
+    compactIfNeeded();
+    mst.onEdgeRemoved(*this, u, v);
 }
 
-std::vector<std::tuple<int, int, int>> Graph::getEdges() {
+const std::vector<std::tuple<int, int, int>>& Graph::getEdges() const {
     return mstEdges;
 }
 
-void Graph::addMSTEdge(int u, int v, int weight) {
-    mstEdges.push_back({weight, u, v});
-    adjMatrix[u][v] = weight;
-    adjMatrix[v][u] = weight;  // Assuming undirected
+const std::vector<std::tuple<int, int, int>>& Graph::getMST() {
+    if (!mst.isValid()) {
+        // Readers of this version may already have computed the forest
+        const auto* forest = lazyForest.peek(mst.version());
+        if (forest != nullptr) {
+            mst.adopt(*forest);
+        } else {
+            mst.rebuild(*this);
+        }
+    }
+    mst.markQueried();
+    return mst.edges();
 }
 
-// Get total weight of MST
-int Graph::getTotalWeight() {
-    int totalWeight = 0;
-    for (const auto& edge : mstEdges) {
-        totalWeight += std::get<0>(edge);
-    }
-    return totalWeight;
+TreePath Graph::getTreePath(int start, int end) {
+    const auto& tree = getMST();
+    return pathIndex.get(mst.version(), [&]() { return TreePathIndex(V, tree); }).query(start, end);
 }
 
-// Get the longest distance in the MST
-int Graph::getLongestDistance() {
-    int longest = 0;
-    for (const auto& edge : mstEdges) {
-        longest = std::max(longest, std::get<0>(edge));
-    }
-    return longest;
+int Graph::degree(int u) const {
+    int count = 0;
+    forEachNeighbor(u, [&count](int, int) { ++count; });
+    return count;
 }
 
-// Get the average distance between edges in the MST
-double Graph::getAverageDistance() {
-    if (mstEdges.empty()) return 0;
-    int totalDistance = 0;
-    for (const auto& edge : mstEdges) {
-        totalDistance += std::get<0>(edge);
-    }
-    return static_cast<double>(totalDistance) / mstEdges.size();
+void Graph::compactIfNeeded() {
+    std::size_t threshold = std::max(MIN_COMPACT_THRESHOLD, csrNeighbors.size() / 4);
+    if (overlayEntries + tombstones > threshold) compact();
 }
 
-// Get the shortest distance in the MST
-int Graph::getShortestDistance() {
-    int shortest = std::numeric_limits<int>::max();
-    for (const auto& edge : mstEdges) {
-        shortest = std::min(shortest, std::get<0>(edge));
-    }
-    return shortest == std::numeric_limits<int>::max() ? 0 : shortest;
+// Rebuild the CSR arrays from the live base slots plus the overlay in O(V + E)
+void Graph::compact() {
+    if (overlayEntries == 0 && tombstones == 0) return;
+    rebuildCSR(mstEdges.size());
 }
 
-// Dijkstra's algorithm to find the shortest path between two vertices
-int Graph::getShortestPath(int start, int end) {
-    std::vector<int> dist(V, std::numeric_limits<int>::max());
-    dist[start] = 0;
-
-    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> pq;
-    pq.push({0, start});
-
-    while (!pq.empty()) {
-        int u = pq.top().second;
-        pq.pop();
-
-        for (int v = 0; v < V; ++v) {
-            if (adjMatrix[u][v] != -1) {  // There's an edge
-                int weight = adjMatrix[u][v];
-                if (dist[u] + weight < dist[v]) {
-                    dist[v] = dist[u] + weight;
-                    pq.push({dist[v], v});
-                }
-            }
+// Merge the live base slots, the overlay and mstEdges[firstNew..] into fresh CSR arrays
+void Graph::rebuildCSR(std::size_t firstNew) {
+    std::vector<std::size_t> offsets(V + 1, 0);
+    for (int u = 0; u < V; ++u) {
+        std::size_t live = 0;
+        for (std::size_t i = csrOffsets[u]; i < csrOffsets[u + 1]; ++i) {
+            if (csrNeighbors[i] >= 0) ++live;
         }
+        offsets[u + 1] = live;
     }
-    return dist[end];
+    for (const auto& entry : overlay) {
+        offsets[entry.first + 1] += entry.second.size();
+    }
+    for (std::size_t i = firstNew; i < mstEdges.size(); ++i) {
+        int u = std::get<1>(mstEdges[i]), v = std::get<2>(mstEdges[i]);
+        ++offsets[u + 1];
+        if (u != v) ++offsets[v + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<int> neighbors(offsets[V]);
+    std::vector<int> weights(offsets[V]);
+    std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < V; ++u) {
+        for (std::size_t i = csrOffsets[u]; i < csrOffsets[u + 1]; ++i) {
+            if (csrNeighbors[i] < 0) continue;
+            neighbors[cursor[u]] = csrNeighbors[i];
+            weights[cursor[u]++] = csrWeights[i];
+        }
+    }
+    for (const auto& entry : overlay) {
+        int u = entry.first;
+        for (const auto& neighbor : entry.second) {
+            neighbors[cursor[u]] = neighbor.first;
+            weights[cursor[u]++] = neighbor.second;
+        }
+    }
+    for (std::size_t i = firstNew; i < mstEdges.size(); ++i) {
+        int weight = std::get<0>(mstEdges[i]), u = std::get<1>(mstEdges[i]), v = std::get<2>(mstEdges[i]);
+        neighbors[cursor[u]] = v;
+        weights[cursor[u]++] = weight;
+        if (u == v) continue;
+        neighbors[cursor[v]] = u;
+        weights[cursor[v]++] = weight;
+    }
+
+    csrOffsets.swap(offsets);
+    csrNeighbors.swap(neighbors);
+    csrWeights.swap(weights);
+    overlay.clear();
+    overlayEntries = 0;
+    tombstones = 0;
 }
 
-// Use a simple DFS for finding the longest path in the graph
-int Graph::getLongestPath(int start, int end) {
-    std::vector<bool> visited(V, false);
-    int longestPath = 0;
+const MSTStats& Graph::getMSTStats() {
+    const auto& tree = getMST();
+    return stats.get(mst.version(), [&]() { return computeMSTStats(V, tree); });
+}
 
-    // Lambda function to perform DFS and track the longest path
-    std::function<void(int, int)> dfs = [&](int u, int distance) {
-        visited[u] = true;  // Mark node as visited
+void Graph::freeze() {
+    compact();
+    getMST();
+    getTreePath(0, 0);
+    getMSTStats();
+}
 
-        // If we reach the target node, update the longest path
-        if (u == end) {
-            longestPath = std::max(longestPath, distance);
-        } else {
-            // Explore all adjacent vertices
-            for (int v = 0; v < V; ++v) {
-                if (!visited[v] && adjMatrix[u][v] != -1) {  // If edge exists and vertex is not visited
-                    dfs(v, distance + adjMatrix[u][v]);  // Recursive DFS call
-                }
-            }
-        }
+void Graph::settle() {
+    if (mst.isValid()) {
+        mst.markQueried();
+        return;
+    }
+    const auto* forest = lazyForest.peek(mst.version());
+    if (forest != nullptr) mst.adopt(*forest);
+}
 
-        visited[u] = false;  // Backtrack: mark the node as unvisited for other paths
-    };
+// The const queries build whatever the graph lacks on first use, once per MST version, and
+// share it with every other reader of this graph
+const std::vector<std::tuple<int, int, int>>& Graph::getMST() const {
+    if (mst.isValid()) return mst.edges();
+    return lazyForest.get(mst.version(), [this]() { return KruskalMST(resolveThreadCount(0), false).computeMST(*this); });
+}
+
+TreePath Graph::getTreePath(int start, int end) const {
+    return pathIndex.get(mst.version(), [this]() { return TreePathIndex(V, getMST()); }).query(start, end);
+}
 
-    // Start DFS from the 'start' node
-    dfs(start, 0);
-    
-    return longestPath;  // Return the longest path found
+MSTStats Graph::getMSTStats() const {
+    return stats.get(mst.version(), [this]() { return computeMSTStats(V, getMST()); });
 }
 
+// Get total weight of MST
+long long Graph::getTotalWeight() {
+    return getMSTStats().totalWeight;
+}
 
+// Get the longest distance between two vertices in the MST (its diameter)
+long long Graph::getLongestDistance() {
+    return getMSTStats().diameter;
+}
+
+// Get the average distance over all pairs of vertices connected by the MST
+double Graph::getAverageDistance() {
+    return getMSTStats().averageDistance;
+}
+
+// Get the shortest distance between two distinct vertices in the MST
+long long Graph::getShortestDistance() {
+    return getMSTStats().shortestDistance;
+}
+
+// Dijkstra's algorithm to find the shortest path between two vertices
+int Graph::getShortestPath(int start, int end) {
+    long long distance = ShortestPath::distance(*this, start, end);
+    if (distance < 0 || distance > std::numeric_limits<int>::max()) return std::numeric_limits<int>::max();
+    return static_cast<int>(distance);
+}
+
+// Same distance from a search running from both endpoints at once
+int Graph::getShortestPathBidirectional(int start, int end) {
+    long long distance = ShortestPath::bidirectionalDistance(*this, start, end);
+    if (distance < 0 || distance > std::numeric_limits<int>::max()) return std::numeric_limits<int>::max();
+    return static_cast<int>(distance);
+}
 
 // Print the MST edges
 void Graph::printMST() {
-    for (const auto& edge : mstEdges) {
+    for (const auto& edge : getMST()) {
         std::cout << std::get<1>(edge) << " -- " << std::get<2>(edge) << " [weight=" << std::get<0>(edge) << "]" << std::endl;
     }
 }
@@ -1,61 +1,149 @@
 #include "kruskal.hpp"
+#include "edge_list.hpp"
+#include "radix_sort.hpp"
+#include "dsu.hpp"
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <random>
 
-class DSU {
-    std::vector<int> parent, rank;
+KruskalMST::KruskalMST(unsigned numThreads, bool verbose, const CancelToken* cancel)
+    : numThreads(numThreads > 0 ? numThreads : 1), verbose(verbose), cancel(cancel) {}
 
-public:
-    DSU(int n) : parent(n, -1), rank(n, 1) {}
-
-    int find(int i) {
-        if (parent[i] == -1)
-            return i;
-        return parent[i] = find(parent[i]);
-    }
-
-    void unite(int x, int y) {
-        int s1 = find(x);
-        int s2 = find(y);
-
-        if (s1 != s2) {
-            if (rank[s1] < rank[s2]) {
-                parent[s1] = s2;
-            } else if (rank[s1] > rank[s2]) {
-                parent[s2] = s1;
-            } else {
-                parent[s2] = s1;
-                rank[s1] += 1;
-            }
-        }
-    }
-};
-
-std::vector<std::tuple<int, int, int>> KruskalMST::computeMST(Graph& graph) {
-    std::vector<std::tuple<int, int, int>> edges = graph.getEdges();
-    std::sort(edges.begin(), edges.end());  // Sort edges by weight
+std::vector<std::tuple<int, int, int>> KruskalMST::computeMST(const Graph& graph) {
+    const EdgeList edges = EdgeList::fromGraph(graph);
+    std::vector<std::uint32_t> order = radixSortIndices(edges.weight, numThreads);  // Sort edges by weight
+    if (CancelToken::check(cancel)) return {};
 
     DSU dsu(graph.V);  // Initialize DSU for the number of vertices
     std::vector<std::tuple<int, int, int>> mstEdges;
-    int totalWeight = 0;
+    long long totalWeight = 0;
+    const std::size_t target = graph.V > 0 ? static_cast<std::size_t>(graph.V - 1) : 0;
 
-    std::cout << "Kruskal's MST selected edges:\n";
-    for (auto& edge : edges) {
-        int w, u, v;
-        std::tie(w, u, v) = edge;
+    if (verbose) std::cout << "Kruskal's MST selected edges:\n";
+    std::size_t scanned = 0;
+    for (std::uint32_t i : order) {
+        if (mstEdges.size() == target) break;  // The tree is complete
+        if (CancelToken::poll(cancel, ++scanned)) break;
+        int w = edges.weight[i], u = edges.u[i], v = edges.v[i];
 
         // Check if including this edge forms a cycle
         if (dsu.find(u) != dsu.find(v)) {
             dsu.unite(u, v);  // Union the sets
-            mstEdges.push_back(edge);  // Add the edge to MST
+            mstEdges.push_back(edges.tuple(i));  // Add the edge to MST
             totalWeight += w;
 
             // Print the selected edge
-            std::cout << "Kruskal: Edge: " << u << " -- " << v << " (weight: " << w << ")\n";
+            if (verbose) std::cout << "Kruskal: Edge: " << u << " -- " << v << " (weight: " << w << ")\n";
         }
     }
 
-    std::cout << "Kruskal's Total Weight: " << totalWeight << std::endl;
+    if (verbose) std::cout << "Kruskal's Total Weight: " << totalWeight << std::endl;
     return mstEdges;
 };
+
+// Below this many edges Filter-Kruskal sorts directly instead of partitioning further
+static const std::size_t FILTER_KRUSKAL_BASE = 1024;
+
+namespace {
+
+struct FilterKruskalState {
+    const EdgeList& edges;
+    DSU dsu;
+    std::size_t target;
+    bool verbose;
+    const CancelToken* cancel;
+    std::vector<std::tuple<int, int, int>> mstEdges;
+    long long totalWeight = 0;
+    std::mt19937 rng{12345};
+
+    FilterKruskalState(const EdgeList& edges, int V, bool verbose, const CancelToken* cancel)
+        : edges(edges), dsu(V), target(V > 0 ? static_cast<std::size_t>(V - 1) : 0), verbose(verbose), cancel(cancel) {}
+
+    bool done() const { return mstEdges.size() == target; }
+
+    // Plain Kruskal over a small range of edge indices
+    void sortAndScan(std::uint32_t* first, std::uint32_t* last) {
+        std::sort(first, last, [this](std::uint32_t a, std::uint32_t b) {
+            return edges.weight[a] != edges.weight[b] ? edges.weight[a] < edges.weight[b] : a < b;
+        });
+        for (std::uint32_t* it = first; it != last && !done(); ++it) {
+            int u = edges.u[*it], v = edges.v[*it];
+            if (dsu.find(u) != dsu.find(v)) {
+                dsu.unite(u, v);
+                mstEdges.push_back(edges.tuple(*it));
+                totalWeight += edges.weight[*it];
+
+                // Print the selected edge
+                if (verbose) std::cout << "Kruskal: Edge: " << u << " -- " << v << " (weight: " << edges.weight[*it] << ")\n";
+            }
+        }
+    }
+
+    int pickPivot(const std::uint32_t* first, std::size_t n) {
+        int a = edges.weight[first[rng() % n]];
+        int b = edges.weight[first[rng() % n]];
+        int c = edges.weight[first[rng() % n]];
+        return std::max(std::min(a, b), std::min(std::max(a, b), c));  // Median of three
+    }
+
+    // Partitions until depth runs out, then sorts what is left, so skewed weights cannot
+    // recurse O(E) deep. The heavy side is handled by the loop rather than a second call.
+    void run(std::uint32_t* first, std::uint32_t* last, int depth) {
+        while (true) {
+            std::size_t n = static_cast<std::size_t>(last - first);
+            if (n == 0 || done() || CancelToken::check(cancel)) return;
+            if (n <= FILTER_KRUSKAL_BASE || depth <= 0) {
+                sortAndScan(first, last);
+                return;
+            }
+            --depth;
+
+            // Quicksort-style partition: light edges first, heavy edges after
+            int pivot = pickPivot(first, n);
+            std::uint32_t* split = std::partition(first, last, [this, pivot](std::uint32_t e) {
+                return edges.weight[e] <= pivot;
+            });
+            if (split == last) {
+                // Every edge is at most the pivot; split off the ones strictly lighter instead
+                split = std::partition(first, last, [this, pivot](std::uint32_t e) {
+                    return edges.weight[e] < pivot;
+                });
+                if (split == first) {  // All weights equal, nothing left to partition on
+                    sortAndScan(first, last);
+                    return;
+                }
+            }
+
+            run(first, split, depth);
+            if (done()) return;
+
+            // Drop heavy edges whose endpoints the light side already joined
+            std::uint32_t* kept = std::partition(split, last, [this](std::uint32_t e) {
+                return dsu.find(edges.u[e]) != dsu.find(edges.v[e]);
+            });
+            first = split;
+            last = kept;
+        }
+    }
+};
+
+}  // namespace
+
+// Filter-Kruskal: recurse on the light half first, then filter the heavy half against the
+// DSU so edges that can never enter the MST are discarded without ever being sorted
+std::vector<std::tuple<int, int, int>> KruskalMST::computeFilterMST(const Graph& graph) {
+    const EdgeList edges = EdgeList::fromGraph(graph);
+    std::vector<std::uint32_t> order(edges.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<std::uint32_t>(i);
+
+    FilterKruskalState state(edges, graph.V, verbose, cancel);
+    if (verbose) std::cout << "Filter-Kruskal's MST selected edges:\n";
+    // Twice the depth of a balanced partition, as introsort allows
+    int depth = 0;
+    for (std::size_t n = order.size(); n > 1; n >>= 1) depth += 2;
+    state.run(order.data(), order.data() + order.size(), depth);
+
+    if (verbose) std::cout << "Filter-Kruskal's Total Weight: " << state.totalWeight << std::endl;
+    return state.mstEdges;
+}
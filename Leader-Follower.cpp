@@ -1,27 +1,40 @@
 #include <iostream>
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <cstring>
+#include <cerrno>
+#include <cstdlib>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
+#include <unordered_map>
+#include <memory>
+#include <future>
 #include <unistd.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include "graph.hpp"  // Include your Graph class
+#include "graph_registry.hpp"
+#include "binary_protocol.hpp"
+#include "edge_loader.hpp"
+#include "graph_snapshot.hpp"
+#include "job_manager.hpp"
+#include "metrics.hpp"
 #include "mst_factory.hpp"
+#include "parallel.hpp"
+#include "server_common.hpp"
 
 #define PORT 8081
-#define BUFFER_SIZE 1024
-
-Graph currentGraph(0);  // Global graph object
+#define BUFFER_SIZE 65536
 
 // Menu display
 std::string menu =
     "Menu:\n"
-    "1. Create a new graph with a specified number of vertices\n"
+    "1. Create a new graph with a specified number of vertices (replaces the current graph)\n"
     "2. Add an edge to the graph (provide: from, to, weight)\n"
     "3. Remove an edge from the graph (provide: from, to)\n"
     "4. Get total weight of MST (Prim algorithm)\n"
@@ -30,146 +43,603 @@ std::string menu =
     "7. Get shortest path in MST (provide: start, end)\n"
     "8. Print MST (Prim algorithm)\n"
     "9. Print MST (Kruskal algorithm)\n"
-    "10. Exit\n";
+    "10. Exit\n"
+    "11. Create a named graph and switch to it (provide: name, vertices)\n"
+    "12. Switch to a named graph (provide: name)\n"
+    "13. Drop a named graph (provide: name)\n"
+    "14. Load an edge-list file into the current graph (provide: path in the server's data directory)\n"
+    "15. Save the current graph to a snapshot file (provide: path in the server's data directory)\n"
+    "16. Load a snapshot file into the current graph (provide: path in the server's data directory)\n"
+    "17. Show server statistics\n"
+    "18. Start a background MST job on the current graph (provide: algorithm, optional timeout in ms)\n"
+    "19. Start a background shortest-path job (provide: start, end, optional timeout in ms)\n"
+    "20. Show a job's status (provide: job id)\n"
+    "21. Get a job's result (provide: job id)\n"
+    "22. Cancel a job (provide: job id)\n"
+    "23. Show the minimum spanning forest, largest trees first\n";
+
+// Per-command latency histograms, indexed by menu option
+static const std::vector<int> textMetrics = commandMetrics({
+    "invalid", "create", "add_edge", "remove_edge", "mst_prim", "mst_kruskal", "longest_path", "shortest_path",
+    "print_mst_prim", "print_mst_kruskal", "exit", "create_named", "open_graph", "drop_graph", "load_file",
+    "save_snapshot", "load_snapshot", "stats", "submit_mst", "submit_shortest_path", "job_status", "job_result",
+    "cancel_job", "forest"});
+
+// Per-connection state; only the thread holding the connection's event touches it
+struct ClientSession {
+    ClientSession(int fd, GraphRegistry::Handle graph) : fd(fd), graph(graph) {}
+
+    int fd;
+    GraphRegistry::Handle graph;  // Graph the session's commands apply to
+    BinaryProtocol::Mode mode = BinaryProtocol::UNDECIDED;  // Text menu or binary frames
+    std::string input;      // Bytes received but not yet consumed as a full line or frame
+    std::string output;     // Replies the socket has not accepted yet, flushed on EPOLLOUT
+    int pendingChoice = 0;  // Menu option waiting for its arguments, 0 when expecting a choice
+    bool closing = false;   // No more requests are read; closed once output is flushed
+};
 
-// Function to send a string message to the client
-void sendMessage(int client_fd, const std::string& message) {
-    send(client_fd, message.c_str(), message.size(), 0);
+// Prompt sent after a choice that takes arguments, empty for choices that run immediately
+static std::string promptFor(int choice) {
+    switch (choice) {
+        case 1: return "Enter the number of vertices:\n";
+        case 2: return "Enter 'from', 'to', and 'weight' for the edge:\n";
+        case 3: return "Enter 'from' and 'to' of the edge to remove:\n";
+        case 6: return "Enter 'start' and 'end' vertices for the longest path:\n";
+        case 7: return "Enter 'start' and 'end' vertices for the shortest path:\n";
+        case 11: return "Enter the graph name and its number of vertices:\n";
+        case 12: return "Enter the name of the graph to switch to:\n";
+        case 13: return "Enter the name of the graph to drop:\n";
+        case 14: return "Enter the path of the edge-list file:\n";
+        case 15: return "Enter the path to save the snapshot to:\n";
+        case 16: return "Enter the path of the snapshot file:\n";
+        case 18: return "Enter the algorithm (prim, prim-dense, kruskal, filter-kruskal, boruvka, boruvka-parallel) and optionally a timeout in ms:\n";
+        case 19: return "Enter 'start' and 'end' vertices and optionally a timeout in ms:\n";
+        case 20:
+        case 21:
+        case 22: return "Enter the job id:\n";
+        default: return "";
+    }
 }
 
-// Function to handle client requests based on the menu
-void handleClientRequest(int client_fd) {
-    char buffer[BUFFER_SIZE] = {0};
+// A text-mode edge update waiting for its graph's shard with the reply it earns, or (without
+// a future) the prompt for the next update, queued behind the replies it must follow
+struct PendingTextWrite {
+    std::future<void> done;
+    std::string reply;
+};
+
+// Answer the queued text writes in order; a write that failed on the shard is reported to
+// this client only
+void finishTextWrites(std::vector<PendingTextWrite>& inFlight, std::string& out) {
+    for (auto& write : inFlight) {
+        if (!write.done.valid()) {
+            out += write.reply;
+            continue;
+        }
+        try {
+            write.done.get();
+            out += write.reply;
+        } catch (const std::exception& error) {
+            out += std::string("Request failed: ") + error.what() + "\n";
+        }
+        out += menu;
+    }
+    inFlight.clear();
+}
 
-    // Send the menu to the client
-    sendMessage(client_fd, menu);
+// Handle one line of client input; returns false once the client asked to exit.
+// Edge additions and removals are queued in inFlight rather than waited for, so the run of
+// them a client pipelines reaches the graph's shard together and is published as one copy
+// of the graph; they are answered by finishTextWrites before any later reply.
+bool handleClientRequest(GraphRegistry& graphs, JobManager& jobs, ClientSession& session, const std::string& line,
+                         std::vector<PendingTextWrite>& inFlight) {
+    std::string& out = session.output;  // Written out by the pool once the request is done
+    int choice = session.pendingChoice;
+    int args[3] = {0, 0, 0};
+    std::string name;
 
-    while (true) {
-        // Clear buffer and read client input
-        memset(buffer, 0, BUFFER_SIZE);
-        read(client_fd, buffer, BUFFER_SIZE);
-        int choice = std::stoi(buffer);
-        std::cout << "Thread " << std::this_thread::get_id() << " is handling the request\n";
+    if (choice == 0) {
+        if (parseInts(line, &choice, 1) != 1) choice = -1;
+        bool edgeUpdate = choice == 2 || choice == 3;
+        if (!edgeUpdate) finishTextWrites(inFlight, out);
+        std::string prompt = promptFor(choice);
+        if (!prompt.empty()) {
+            session.pendingChoice = choice;
+            if (edgeUpdate) {
+                inFlight.push_back({std::future<void>(), prompt});
+            } else {
+                out += prompt;
+            }
+            return true;
+        }
+    } else {
+        session.pendingChoice = 0;
+        if (choice != 2 && choice != 3) finishTextWrites(inFlight, out);
+        bool valid;
+        if (choice == 18) {
+            std::size_t end = parseWord(line, name);
+            valid = end > 0;
+            if (valid) parseInts(line.substr(end), args, 1);  // The timeout is optional
+        } else if (choice == 19) {
+            valid = parseInts(line, args, 3) >= 2;
+        } else if (choice >= 20) {
+            valid = parseInts(line, args, 1) == 1;
+        } else if (choice >= 14) {
+            name = trimmed(line);
+            valid = !name.empty();
+        } else if (choice >= 11) {
+            std::size_t end = parseWord(line, name);
+            valid = end > 0 && (choice != 11 || parseInts(line.substr(end), args, 1) == 1);
+        } else {
+            int needed = choice == 2 ? 3 : (choice == 1 ? 1 : 2);
+            valid = parseInts(line, args, needed) == needed;
+        }
+        if (!valid) {
+            finishTextWrites(inFlight, out);
+            out += "Invalid input. Please try again.\n";
+            out += menu;
+            return true;
+        }
+    }
+
+    Metrics::ScopedTimer timer(commandMetric(textMetrics, choice));
+    std::string notice;
+    if (((choice >= 1 && choice <= 9) || (choice >= 14 && choice <= 16) || choice == 18 || choice == 19 || choice == 23) &&
+        !checkCurrentGraph(graphs, session.graph, notice)) {
+        finishTextWrites(inFlight, out);
+        out += notice;
+        out += menu;
+        return true;
+    }
+
+    if (choice == 2 || choice == 3) {
+        std::function<void(Graph&)> fn;
+        if (choice == 2) {
+            fn = [args](Graph& graph) { graph.addEdge(args[0], args[1], args[2]); };
+        } else {
+            fn = [args](Graph& graph) { graph.removeEdge(args[0], args[1]); };
+        }
+        inFlight.push_back({graphs.update(session.graph, std::move(fn)),
+                            choice == 2 ? "Edge added successfully!\n" : "Edge removed successfully!\n"});
+        return true;
+    }
+
+    // Other mutations run on the graph's shard and are waited for, which keeps replies in
+    // request order. A failed one (say, out of memory) rethrows here and is reported to this
+    // client only.
+    GraphStore& currentGraph = session.graph->store;
+    try {
         switch (choice) {
             case 1:
-                sendMessage(client_fd, "Enter the number of vertices:\n");
-                read(client_fd, buffer, BUFFER_SIZE);
-                currentGraph = Graph(std::stoi(buffer));
-                sendMessage(client_fd, "Graph created successfully!\n");
-                break;
-            case 2: {
-                sendMessage(client_fd, "Enter 'from', 'to', and 'weight' for the edge:\n");
-                read(client_fd, buffer, BUFFER_SIZE);
-                int from, to, weight;
-                sscanf(buffer, "%d %d %d", &from, &to, &weight);
-                currentGraph.addEdge(from, to, weight);
-                sendMessage(client_fd, "Edge added successfully!\n");
+                if (!Graph::isValidVertexCount(args[0])) {
+                    out += invalidVertexCount();
+                    break;
+                }
+                graphs.reset(session.graph, args[0]).get();
+                out += "Graph created successfully!\n";
                 break;
-            }
-            case 3: {
-                sendMessage(client_fd, "Enter 'from' and 'to' of the edge to remove:\n");
-                read(client_fd, buffer, BUFFER_SIZE);
-                int from, to;
-                sscanf(buffer, "%d %d", &from, &to);
-                currentGraph.removeEdge(from, to);
-                sendMessage(client_fd, "Edge removed successfully!\n");
-                break;
-            }
-            case 4: {
-                int totalWeight = currentGraph.getTotalWeight();
-                sendMessage(client_fd, "Total weight of MST (Prim): " + std::to_string(totalWeight) + "\n");
-                break;
-            }
+            case 4:
             case 5: {
-                int totalWeight = currentGraph.getTotalWeight();
-                sendMessage(client_fd, "Total weight of MST (Kruskal): " + std::to_string(totalWeight) + "\n");
+                // Run the named algorithm itself rather than reading the maintained MST
+                const bool prim = choice == 4;
+                long long totalWeight = 0;
+                for (const auto& edge : timedMST(*currentGraph.snapshot(), prim ? "prim" : "kruskal")) {
+                    totalWeight += std::get<0>(edge);
+                }
+                out += std::string("Total weight of MST (") + (prim ? "Prim" : "Kruskal") + "): " +
+                       std::to_string(totalWeight) + "\n";
                 break;
             }
-            case 6: {
-                sendMessage(client_fd, "Enter 'start' and 'end' vertices for the longest path:\n");
-                read(client_fd, buffer, BUFFER_SIZE);
-                int start, end;
-                sscanf(buffer, "%d %d", &start, &end);
-                int longestPath = currentGraph.getLongestPath(start, end);
-                sendMessage(client_fd, "Longest path: " + std::to_string(longestPath) + "\n");
+            case 6:
+                // A tree has exactly one path between two vertices
+                out += formatTreePath("Longest path", args[0], args[1], timedTreePath(*currentGraph.snapshot(), args[0], args[1]));
                 break;
-            }
-            case 7: {
-                sendMessage(client_fd, "Enter 'start' and 'end' vertices for the shortest path:\n");
-                read(client_fd, buffer, BUFFER_SIZE);
-                int start, end;
-                sscanf(buffer, "%d %d", &start, &end);
-                int shortestPath = currentGraph.getShortestPath(start, end);
-                sendMessage(client_fd, "Shortest path: " + std::to_string(shortestPath) + "\n");
+            case 7:
+                out += formatTreePath("Shortest path", args[0], args[1], timedTreePath(*currentGraph.snapshot(), args[0], args[1]));
                 break;
-            }
             case 8:
-                sendMessage(client_fd, "MST Edges (Prim):\n");
-                currentGraph.printMST();
+                out += "MST Edges (Prim):\n" + formatMST(timedMST(*currentGraph.snapshot(), "prim"));
                 break;
             case 9:
-                sendMessage(client_fd, "MST Edges (Kruskal):\n");
-                currentGraph.printMST();
+                out += "MST Edges (Kruskal):\n" + formatMST(timedMST(*currentGraph.snapshot(), "kruskal"));
                 break;
             case 10:
-                sendMessage(client_fd, "Goodbye!\n");
-                close(client_fd);
-                return;
+                out += "Goodbye!\n";
+                return false;
+            case 11:
+                out += createNamedGraph(graphs, session.graph, name, args[0]);
+                break;
+            case 12:
+                out += openNamedGraph(graphs, session.graph, name);
+                break;
+            case 13:
+                out += dropNamedGraph(graphs, session.graph, name);
+                break;
+            case 14: {
+                std::string path, error;
+                if (!resolveDataPath(name, path, error)) {
+                    out += error + "\n";
+                    break;
+                }
+                auto result = std::make_shared<EdgeLoader::LoadResult>();
+                graphs.update(session.graph, EdgeLoader::loadInto(path, result)).get();
+                out += EdgeLoader::describe(*result, name) + "\n";
+                break;
+            }
+            case 15:
+            case 16: {
+                std::string path, error;
+                if (!resolveDataPath(name, path, error)) {
+                    out += error + "\n";
+                    break;
+                }
+                // Both run on the graph's shard, ordered with the writes of every session
+                auto result = std::make_shared<GraphSnapshot::Result>();
+                bool saving = choice == 15;
+                graphs.update(session.graph, saving ? GraphSnapshot::saveFrom(path, result)
+                                                    : GraphSnapshot::loadInto(path, result)).get();
+                out += GraphSnapshot::describe(*result, name, saving) + "\n";
+                break;
+            }
+            case 17:
+                out += Metrics::report();
+                break;
+            case 18:
+                out += submitMSTJob(jobs, session.graph, name, args[0]);
+                break;
+            case 19:
+                out += submitPathJob(jobs, session.graph, args[0], args[1], args[2]);
+                break;
+            case 20:
+                out += jobStatus(jobs, args[0]);
+                break;
+            case 21:
+                out += takeJobResult(jobs, args[0]);
+                break;
+            case 22:
+                out += cancelJob(jobs, args[0]);
+                break;
+            case 23:
+                out += formatForest(timedForest(*currentGraph.snapshot()));
+                break;
             default:
-                sendMessage(client_fd, "Invalid choice. Please try again.\n");
+                out += "Invalid choice. Please try again.\n";
+        }
+    } catch (const std::exception& error) {
+        out += std::string("Request failed: ") + error.what() + "\n";
+    }
+
+    // Send the menu again for next operation
+    out += menu;
+    return true;
+}
+
+// A pipelined write waiting for its graph's shard
+struct PendingWrite {
+    std::uint8_t opcode;
+    std::future<void> done;
+};
+
+// Answer the queued writes in order once their shard ran them; a write that failed on the
+// shard gets an error response instead of OK
+void finishWrites(std::vector<PendingWrite>& inFlight, std::string& out) {
+    for (auto& write : inFlight) {
+        try {
+            write.done.get();
+            BinaryProtocol::appendOk(out, write.opcode);
+        } catch (const std::exception& error) {
+            BinaryProtocol::appendError(out, write.opcode, std::string("Request failed: ") + error.what());
         }
+    }
+    inFlight.clear();
+}
 
-        // Send the menu again for next operation
-        sendMessage(client_fd, menu);
+// Handle one binary frame, appending its response to out; returns false on CLOSE.
+// Mutations are only waited for before the next read, so a run of pipelined writes reaches
+// the graph's shard together and is published as one version.
+bool handleFrame(GraphRegistry& graphs, JobManager& jobs, ClientSession& session, const BinaryProtocol::Frame& frame,
+                 std::vector<PendingWrite>& inFlight, std::string& out) {
+    using namespace BinaryProtocol;
+    Metrics::ScopedTimer timer(opcodeMetric(frame.opcode));
+    Command command = decode(frame);
+    std::string notice;
+    if (command.error.empty() && command.isMutation() && !command.isFileCommand() &&
+        checkCurrentGraph(graphs, session.graph, notice)) {
+        inFlight.push_back({command.opcode, graphs.update(session.graph, std::move(command.mutation))});
+        return true;  // Answered by finishWrites
+    }
+
+    finishWrites(inFlight, out);
+    if (!command.error.empty() || !notice.empty()) {
+        appendError(out, command.opcode, command.error.empty() ? notice : command.error);
+        return true;
+    }
+    if (command.opcode == CLOSE) {
+        appendOk(out, command.opcode);
+        return false;
+    }
+    if (command.opcode == STATS) {
+        appendStats(out);
+        return true;
+    }
+    try {
+        if (command.isRegistry()) {
+            runRegistryCommand(graphs, session.graph, command, out);
+            return true;
+        }
+        if (command.isJob() && !command.isSubmit()) {
+            runJobCommand(jobs, session.graph, command, out);
+            return true;
+        }
+        if (!checkCurrentGraph(graphs, session.graph, notice)) {
+            appendError(out, command.opcode, notice);
+            return true;
+        }
+        if (command.isSubmit()) {
+            runJobCommand(jobs, session.graph, command, out);  // Sees every write sent before it
+            return true;
+        }
+        if (command.isFileCommand()) graphs.update(session.graph, command.mutation).get();
+        answerQuery(command, *session.graph->store.snapshot(), out);
+    } catch (const std::exception& error) {
+        appendError(out, command.opcode, std::string("Request failed: ") + error.what());
     }
+    return true;
 }
 
 // Leader-Follower Thread Pool
+// One thread at a time (the leader) waits on an epoll set holding the listening socket and
+// every client socket. When an event arrives the leader promotes a follower to take over
+// the wait and then processes that single ready socket itself. Sockets are registered with
+// EPOLLONESHOT, so a connection is never handled by two threads at once and is re-armed
+// once its ready input has been consumed. Idle connections cost no thread.
+// Replies are written without blocking; what the socket does not take stays in the session
+// and is flushed when EPOLLOUT reports room, and a session with MAX_OUTPUT_BACKLOG unsent
+// stops being read until its peer catches up. Slow readers therefore never hold a thread.
+// The pool reports how many threads queue for the leader role, how many are busy serving a
+// socket, and how long each ready socket takes.
 class LeaderFollowerPool {
-    std::queue<int> clientQueue;
+    GraphRegistry& graphs;
+    JobManager& jobs;
+    int listen_fd;
+    int epoll_fd;
     std::mutex mtx;
     std::condition_variable cv;
+    bool hasLeader = false;
     bool running = true;
     std::vector<std::thread> workers;
 
+    std::atomic<int> followers{0};  // Threads waiting for the leader role
+    std::atomic<int> busy{0};       // Threads serving a ready socket
+    std::vector<int> gauges;
+    const int eventMetric = Metrics::histogram("lf.event_service");
+    const int requestsMetric = Metrics::histogram("lf.requests_per_event", Metrics::COUNT);
+    const int acceptedMetric = Metrics::counter("connections.accepted");
+
+    std::mutex sessionsMtx;
+    std::unordered_map<int, std::shared_ptr<ClientSession>> sessions;
+
+    void rearm(int fd) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+    }
+
+    // Wait for what the session needs next: more requests unless it is closing or its
+    // replies are backed up, and room in the socket while replies are pending
+    void rearm(const ClientSession& session, int op = EPOLL_CTL_MOD) {
+        epoll_event ev{};
+        ev.events = EPOLLONESHOT;
+        if (!session.closing && session.output.size() < MAX_OUTPUT_BACKLOG) ev.events |= EPOLLIN | EPOLLRDHUP;
+        if (!session.output.empty()) ev.events |= EPOLLOUT;
+        ev.data.fd = session.fd;
+        epoll_ctl(epoll_fd, op, session.fd, &ev);
+    }
+
+    void acceptClients() {
+        while (true) {
+            int client_fd = accept(listen_fd, nullptr, nullptr);
+            if (client_fd < 0) break;  // EAGAIN: backlog drained
+            setNonBlocking(client_fd);
+            auto session = std::make_shared<ClientSession>(client_fd, graphs.open(GraphRegistry::DEFAULT_GRAPH));
+            session->output = menu;
+            {
+                std::lock_guard<std::mutex> lock(sessionsMtx);
+                sessions[client_fd] = session;
+            }
+            Metrics::add(acceptedMetric);
+            std::cout << "New client connected!" << std::endl;
+
+            // Not in the epoll set yet, so no other thread can touch the session here
+            if (flushOutput(client_fd, session->output)) {
+                rearm(*session, EPOLL_CTL_ADD);
+            } else {
+                closeClient(client_fd);
+            }
+        }
+        rearm(listen_fd);
+    }
+
+    void closeClient(int client_fd) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, nullptr);
+        {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            sessions.erase(client_fd);
+        }
+        close(client_fd);
+    }
+
+    // Run every complete frame in the input in place and queue their answers in order;
+    // returns false once the connection should close
+    bool serveFrames(ClientSession& session, std::size_t& requests) {
+        std::string& out = session.output;
+        std::vector<PendingWrite> inFlight;
+        std::size_t offset = 0;
+        BinaryProtocol::Frame frame;
+        bool keepOpen = true;
+        int found = 0;
+        while (keepOpen && (found = BinaryProtocol::nextFrame(session.input, offset, frame)) == 1) {
+            keepOpen = handleFrame(graphs, jobs, session, frame, inFlight, out);
+            ++requests;
+        }
+        finishWrites(inFlight, out);
+        if (keepOpen && found < 0) {
+            BinaryProtocol::appendError(out, 0, "Frame too large");
+            keepOpen = false;
+        }
+        session.input.erase(0, offset);
+        return keepOpen;
+    }
+
+    // Drain the socket, run every complete line or frame it delivered and write out as much
+    // of the replies as the socket takes; the rest waits for EPOLLOUT, so a slow reader
+    // never holds a thread
+    void serveClient(int client_fd, std::uint32_t events) {
+        std::shared_ptr<ClientSession> session;
+        {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            auto it = sessions.find(client_fd);
+            if (it == sessions.end()) return;
+            session = it->second;
+        }
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            closeClient(client_fd);  // Nothing can be read or written any more
+            return;
+        }
+
+        std::size_t requests = 0;
+        if (!session->closing && session->output.size() < MAX_OUTPUT_BACKLOG) {
+            char buffer[BUFFER_SIZE];
+            std::size_t readLimit = session->input.size() + MAX_READ_PER_EVENT;
+            while (session->input.size() < readLimit) {
+                ssize_t n = read(client_fd, buffer, sizeof(buffer));
+                if (n > 0) {
+                    session->input.append(buffer, static_cast<std::size_t>(n));
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) session->closing = true;
+                    break;
+                }
+            }
+
+            if (session->mode == BinaryProtocol::UNDECIDED) {
+                session->mode = BinaryProtocol::detectMode(session->input);
+                if (session->mode == BinaryProtocol::BINARY) {
+                    session->input.erase(0, BinaryProtocol::PREAMBLE_SIZE);
+                    session->output.append(BinaryProtocol::PREAMBLE, BinaryProtocol::PREAMBLE_SIZE);
+                } else if (session->mode == BinaryProtocol::INVALID) {
+                    session->closing = true;
+                }
+            }
+
+            if (session->mode == BinaryProtocol::BINARY) {
+                if (!serveFrames(*session, requests)) session->closing = true;
+            } else if (session->mode == BinaryProtocol::TEXT) {
+                std::string line;
+                std::vector<PendingTextWrite> inFlight;
+                while (takeLine(session->input, line)) {
+                    ++requests;
+                    if (!handleClientRequest(graphs, jobs, *session, line, inFlight)) {
+                        session->closing = true;
+                        break;
+                    }
+                }
+                finishTextWrites(inFlight, session->output);
+                if (!session->closing && session->input.size() > MAX_LINE_LENGTH) {
+                    session->output += LINE_TOO_LONG;
+                    session->closing = true;
+                }
+            }
+            Metrics::record(requestsMetric, requests);
+        }
+
+        if (!flushOutput(client_fd, session->output) || (session->closing && session->output.empty())) {
+            closeClient(client_fd);
+        } else {
+            rearm(*session);
+        }
+    }
+
     void workerFunction() {
-        while (running) {
-            int client_fd;
+        while (true) {
+            // Followers queue up here until the leader role is free
             {
                 std::unique_lock<std::mutex> lock(mtx);
-                cv.wait(lock, [this] { return !clientQueue.empty() || !running; });
-                if (!running && clientQueue.empty()) return;
-                client_fd = clientQueue.front();
-                clientQueue.pop();
+                ++followers;
+                cv.wait(lock, [this] { return !hasLeader || !running; });
+                --followers;
+                if (!running) return;
+                hasLeader = true;
+            }
+
+            epoll_event event{};
+            int ready = 0;
+            while (ready <= 0) {
+                ready = epoll_wait(epoll_fd, &event, 1, 500);
+                if (ready < 0 && errno != EINTR) break;
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!running) break;
             }
 
-            // Handle client request
-            handleClientRequest(client_fd);
+            // Promote a follower, then process the event as an ordinary worker
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                hasLeader = false;
+            }
+            cv.notify_one();
+
+            if (ready <= 0) continue;
+            if (event.data.fd == listen_fd) {
+                acceptClients();
+            } else {
+                ++busy;
+                auto start = std::chrono::steady_clock::now();
+                serveClient(event.data.fd, event.events);
+                Metrics::record(eventMetric, Metrics::nanosSince(start));
+                --busy;
+            }
         }
     }
 
 public:
-    LeaderFollowerPool(int numThreads) {
+    LeaderFollowerPool(int numThreads, int listen_fd, GraphRegistry& graphs, JobManager& jobs)
+        : graphs(graphs), jobs(jobs), listen_fd(listen_fd), epoll_fd(epoll_create1(0)) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.fd = listen_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+
+        gauges.push_back(Metrics::gauge("lf.followers", [this]() { return static_cast<long long>(followers.load()); }));
+        gauges.push_back(Metrics::gauge("lf.busy", [this]() { return static_cast<long long>(busy.load()); }));
+        gauges.push_back(Metrics::gauge("connections.open", [this]() {
+            std::lock_guard<std::mutex> lock(sessionsMtx);
+            return static_cast<long long>(sessions.size());
+        }));
+
         for (int i = 0; i < numThreads; ++i) {
             workers.emplace_back(&LeaderFollowerPool::workerFunction, this);
         }
     }
 
     ~LeaderFollowerPool() {
+        for (int id : gauges) Metrics::removeGauge(id);
         stop();
         for (auto& thread : workers) {
             if (thread.joinable()) {
                 thread.join();
             }
         }
+        close(epoll_fd);
     }
 
-    void submitClient(int client_fd) {
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            clientQueue.push(client_fd);
+    void wait() {
+        for (auto& thread : workers) {
+            if (thread.joinable()) {
+                thread.join();
+            }
         }
-        cv.notify_one();
     }
 
     void stop() {
@@ -182,18 +652,52 @@ public:
 };
 
 // Main function for the Leader-Follower server
-int main() {
-    int server_fd, new_socket;
+// Usage: ./leader_follower_server [threads] [--preload [graph=]snapshot]... [--max-vertices N]
+//        [--data-dir DIR] [--metrics-port N]
+// Threads default to one per hardware thread; each --preload restores a snapshot before serving;
+// --max-vertices bounds every graph clients create or load (default Graph::DEFAULT_VERTEX_LIMIT);
+// --data-dir holds the files clients load and save (default the working directory);
+// --metrics-port serves the statistics report on 127.0.0.1:N
+int main(int argc, char* argv[]) {
+    int server_fd;
     struct sockaddr_in address;
-    int addrlen = sizeof(address);
+
+    int numThreads = static_cast<int>(resolveThreadCount(0));
+    std::vector<std::string> preloads;
+    int metricsPort = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--preload") == 0 && i + 1 < argc) {
+            preloads.push_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-vertices") == 0 && i + 1 < argc) {
+            Graph::setVertexLimit(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--data-dir") == 0 && i + 1 < argc) {
+            setDataDir(argv[++i]);
+        } else if (std::strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metricsPort = std::atoi(argv[++i]);
+        } else if (std::atoi(argv[i]) > 0) {
+            numThreads = std::atoi(argv[i]);
+        }
+    }
+
+    GraphRegistry graphs;  // Named graphs, one shard worker per hardware thread
+    for (const auto& spec : preloads) {
+        if (!preloadSnapshot(graphs, spec)) exit(EXIT_FAILURE);
+    }
+
+    if (metricsPort > 0 && !Metrics::startEndpoint(metricsPort)) {
+        perror("metrics endpoint");
+        exit(EXIT_FAILURE);
+    }
 
     // Creating socket file descriptor
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
+    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
         perror("socket failed");
         exit(EXIT_FAILURE);
     }
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
-    // Bind the socket to port 8080
+    // Bind the socket to the server port
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(PORT);
@@ -204,30 +708,23 @@ int main() {
     }
 
     // Listen for incoming connections
-    if (listen(server_fd, 3) < 0) {
+    if (listen(server_fd, SOMAXCONN) < 0) {
         perror("listen");
         exit(EXIT_FAILURE);
     }
+    setNonBlocking(server_fd);
 
-    std::cout << "Server started and listening on port " << PORT << std::endl;
+    std::cout << "Server started and listening on port " << PORT << " with " << numThreads << " threads" << std::endl;
 
-    LeaderFollowerPool pool(3);  // Create a thread pool with 3 threads
-
-    while (true) {
-        new_socket = accept(server_fd, (struct sockaddr*)&address, (socklen_t*)&addrlen);
-        if (new_socket < 0) {
-            perror("accept");
-            exit(EXIT_FAILURE);
-        }
-        std::cout << "New client connected!" << std::endl;
-        pool.submitClient(new_socket);
-    }
+    JobManager jobs;  // Background MST and path jobs, on low-priority runner threads
+    LeaderFollowerPool pool(numThreads, server_fd, graphs, jobs);  // Threads take turns leading the epoll wait
+    pool.wait();
 
     return 0;
 }
 
 //make
-// ./pipeline_server
-// Server listening on port 8081
+// ./leader_follower_server [threads]
+// Server started and listening on port 8081
 //open a new terminal
-//nc localhost 8081
\ No newline at end of file
+//nc localhost 8081
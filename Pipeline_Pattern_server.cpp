@@ -1,225 +1,901 @@
 #include <iostream>
-#include <queue>
-#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
 #include <thread>
-#include <condition_variable>
 #include <string>
-#include <functional>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cerrno>
 #include <sys/types.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
-#include <cstring>  // For memset
 #include "graph.hpp"
+#include "graph_registry.hpp"
+#include "binary_protocol.hpp"
+#include "edge_loader.hpp"
+#include "graph_snapshot.hpp"
+#include "job_manager.hpp"
 #include "mst_factory.hpp"
+#include "object_pool.hpp"
+#include "active_object.hpp"
+#include "metrics.hpp"
+#include "server_common.hpp"
 
-// Active Object class to manage async tasks
-class ActiveObject {
-    std::queue<std::function<void()>> tasks;
-    std::mutex mtx;
-    std::condition_variable cv;
-    bool done;
-    std::thread worker;
-
-    void run() {
-        while (true) {
-            std::function<void()> task;
-            {
-                std::unique_lock<std::mutex> lock(mtx);
-                cv.wait(lock, [this] { return !tasks.empty() || done; });
-                if (done && tasks.empty()) return;
-                task = std::move(tasks.front());
-                tasks.pop();
-            }
-            task();
-        }
-    }
-
-public:
-    ActiveObject() : done(false), worker(&ActiveObject::run, this) {}
-    ~ActiveObject() {
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            done = true;
-        }
-        cv.notify_all();
-        worker.join();
-    }
-
-    // Enqueue tasks for async execution
-    void submit(std::function<void()> task) {
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            tasks.push(std::move(task));
-        }
-        cv.notify_one();
-    }
-};
+#define PORT 8080
+#define BUFFER_SIZE 65536
 
 // Menu display
 std::string menu =
     "Menu:\n"
-    "1. Create a new graph (provide number of vertices)\n"
+    "1. Create a new graph (provide number of vertices; replaces the current graph)\n"
     "2. Add an edge (provide: from, to, weight)\n"
     "3. Remove an edge (provide: from, to)\n"
     "4. Get total weight of MST\n"
     "5. Get longest path in MST (provide: start, end)\n"
     "6. Get shortest path in MST (provide: start, end)\n"
-    "7. Get average distance between edges in MST\n"
+    "7. Get average distance between vertices in MST\n"
     "8. Print MST\n"
-    "9. Exit\n";
+    "9. Exit\n"
+    "10. Create a named graph and switch to it (provide: name, vertices)\n"
+    "11. Switch to a named graph (provide: name)\n"
+    "12. Drop a named graph (provide: name)\n"
+    "13. Load an edge-list file into the current graph (provide: path in the server's data directory)\n"
+    "14. Save the current graph to a snapshot file (provide: path in the server's data directory)\n"
+    "15. Load a snapshot file into the current graph (provide: path in the server's data directory)\n"
+    "16. Show server statistics\n"
+    "17. Start a background MST job on the current graph (provide: algorithm, optional timeout in ms)\n"
+    "18. Start a background shortest-path job (provide: start, end, optional timeout in ms)\n"
+    "19. Show a job's status (provide: job id)\n"
+    "20. Get a job's result (provide: job id)\n"
+    "21. Cancel a job (provide: job id)\n"
+    "22. Show the minimum spanning forest, largest trees first\n";
+
+// Per-command latency histograms, from parsing in stage 1 to the reply in stage 3
+static const std::vector<int> textMetrics = commandMetrics({
+    "invalid", "create", "add_edge", "remove_edge", "mst_weight", "longest_path", "shortest_path",
+    "average_distance", "print_mst", "exit", "create_named", "open_graph", "drop_graph", "load_file",
+    "save_snapshot", "load_snapshot", "stats", "submit_mst", "submit_shortest_path", "job_status", "job_result",
+    "cancel_job", "forest"});
+
+// Outcome of a request's mutation, filled in by the graph's shard
+struct Applied {
+    std::atomic<bool> done{false};
+    std::exception_ptr error;  // Set before done
+};
 
-// Send a message to the client
-void sendMessage(int client_fd, const std::string& message) {
-    send(client_fd, message.c_str(), message.size(), 0);
+// One parsed client request flowing through the stages
+struct PipelineRequest {
+    enum Kind { Command, Prompt, Notice, Binary, Disconnect, Refuse };  // Refuse: send reply, then close
+
+    Kind kind = Command;
+    int fd = -1;
+    int choice = 0;
+    int args[3] = {0, 0, 0};
+    std::string name;  // Graph name for the registry commands, file path for a load, MST algorithm for a job
+    bool validArgs = true;
+    BinaryProtocol::Command frame;  // Decoded binary frame for Binary requests
+    std::chrono::steady_clock::time_point received;  // When stage 1 parsed it
+
+    // Filled in by stage 2
+    std::string reply;                // Fixed answer for mutations and registry commands, encoded
+                                      // as response frames for Binary requests
+    GraphRegistry::Handle graph;      // Graph the request applies to
+    std::shared_ptr<Applied> applied; // Done once the graph's shard published the mutation
+    std::shared_ptr<EdgeLoader::LoadResult> load;  // Outcome of a file load, valid once applied
+    std::shared_ptr<GraphSnapshot::Result> snapshot;  // Outcome of a snapshot save or load, likewise
+
+    // Make a released request fresh again for the pool. Strings are cleared rather than
+    // replaced, so their buffers serve the next request; a reply buffer past
+    // MAX_KEPT_REPLY is freed so one huge answer does not stay pinned in the pool.
+    struct Reset {
+        static const std::size_t MAX_KEPT_REPLY = 64 * 1024;
+
+        void operator()(PipelineRequest& request) const {
+            request.kind = Command;
+            request.fd = -1;
+            request.choice = 0;
+            request.args[0] = request.args[1] = request.args[2] = 0;
+            request.name.clear();
+            request.validArgs = true;
+            std::string frameName = std::move(request.frame.name);
+            request.frame = BinaryProtocol::Command();
+            request.frame.name = std::move(frameName);
+            request.frame.name.clear();
+            request.received = std::chrono::steady_clock::time_point();
+            if (request.reply.capacity() > MAX_KEPT_REPLY) {
+                std::string().swap(request.reply);
+            } else {
+                request.reply.clear();
+            }
+            request.graph.reset();
+            request.applied.reset();
+            request.load.reset();
+            request.snapshot.reset();
+        }
+    };
+};
+
+// Prompt sent after a choice that takes arguments, nullptr for choices that run immediately
+static const char* promptFor(int choice) {
+    switch (choice) {
+        case 1: return "Enter the number of vertices:\n";
+        case 2: return "Enter 'from', 'to', and 'weight' for the edge:\n";
+        case 3: return "Enter 'from' and 'to' of the edge to remove:\n";
+        case 5: return "Enter 'start' and 'end' vertices for the longest path:\n";
+        case 6: return "Enter 'start' and 'end' vertices for the shortest path:\n";
+        case 10: return "Enter the graph name and its number of vertices:\n";
+        case 11: return "Enter the name of the graph to switch to:\n";
+        case 12: return "Enter the name of the graph to drop:\n";
+        case 13: return "Enter the path of the edge-list file:\n";
+        case 14: return "Enter the path to save the snapshot to:\n";
+        case 15: return "Enter the path of the snapshot file:\n";
+        case 17: return "Enter the algorithm (prim, prim-dense, kruskal, filter-kruskal, boruvka, boruvka-parallel) and optionally a timeout in ms:\n";
+        case 18: return "Enter 'start' and 'end' vertices and optionally a timeout in ms:\n";
+        case 19:
+        case 20:
+        case 21: return "Enter the job id:\n";
+        default: return nullptr;
+    }
+}
+
+static int argumentCount(int choice) {
+    switch (choice) {
+        case 1: return 1;
+        case 2: return 3;
+        default: return 2;
+    }
 }
 
 // Server pipeline class
+// Stage 1 is a readiness-driven parser: one thread owns an epoll set of non-blocking client
+// sockets, splits their input into lines and runs each connection's prompt state machine.
+// Binary-mode connections are split into frames in place instead.
+// Complete requests go to stage 2 (graph routing) and then stage 3 (calculations and every
+// reply), each an ActiveObject fed through a bounded SPSC ring. Stage 2 tracks each
+// connection's current graph, runs the registry commands and hands mutations to the shard
+// that owns the graph, so mutations of different graphs run in parallel. Stage 3 composes
+// every reply. It never blocks: a request whose mutation is still on its shard waits in its
+// connection's queue, together with the requests behind it, and the shard's completion
+// callback has stage 3 pick the queue up again, so replies keep their order while other
+// connections are answered meanwhile. Replies are gathered per connection and handed to
+// stage 1 once stage 3 runs out of queued work; stage 1 writes them without blocking,
+// keeps what a socket does not take until EPOLLOUT, and stops reading from a connection
+// with MAX_OUTPUT_BACKLOG unsent. A connection is only closed by stage 1, after stage 3
+// sent its last reply, so its descriptor cannot be reused while requests are in flight.
+// Background jobs are submitted by stage 3, after the connection's earlier writes were
+// published, and run on the job manager's own threads.
+// Requests come from a pool that stage 1 refills from what stage 3 finished with, and the
+// task carrying one fits in a ring slot, so a request crosses the stages without allocating.
+// Both stages report their queue depth and task wait/service times under "pipeline.stage2"
+// and "pipeline.stage3".
 class PipelineServer {
-    ActiveObject stage1; // Receive and parse graph data
-    ActiveObject stage2; // Apply graph changes (optional)
-    ActiveObject stage3; // Compute MST
-    Graph currentGraph{0}; // Graph object to store the current graph
+    // Connection state owned by the stage 1 thread
+    struct Connection {
+        std::string input;      // Bytes received but not yet consumed as a full line or frame
+        std::string output;     // Replies the socket has not taken yet
+        int pendingChoice = 0;  // Menu option waiting for its arguments, 0 when expecting a choice
+        BinaryProtocol::Mode mode = BinaryProtocol::UNDECIDED;
+        bool retired = false;   // No more input is read; stage 3 sends the last reply
+        bool closing = false;   // Stage 3 sent the last reply; closed once output is out
+        bool broken = false;    // Peer is gone, so output is dropped
+        uint32_t armed = 0;     // Events registered with epoll
+    };
 
-public:
-    PipelineServer() {}
-
-    void handleRequest(int new_socket) {
-        // Send the menu to the client
-        sendMessage(new_socket, menu);
-
-        // Start Stage 1
-        stage1.submit([new_socket, this]() {
-            std::cout << "Processing Stage 1: Receive Client Request for client " << new_socket << std::endl;
-
-            char buffer[1024] = {0}; // Mutable buffer for receiving input
-
-            while (true) {
-                // Clear buffer and read client input
-                memset(buffer, 0, sizeof(buffer));
-                read(new_socket, buffer, sizeof(buffer)); // Ensure buffer is mutable
-                int choice = std::stoi(buffer);
-
-                // Start Stage 2 (Graph Operations)
-                stage2.submit([new_socket, this, choice, buffer]() mutable {
-                    std::cout << "Processing Stage 2: Graph Operation for client " << new_socket << std::endl;
-
-                    switch (choice) {
-                        case 1:
-                            sendMessage(new_socket, "Enter the number of vertices:\n");
-                            read(new_socket, buffer, sizeof(buffer)); // Mutable buffer
-                            currentGraph = Graph(std::stoi(buffer));
-                            sendMessage(new_socket, "Graph created successfully!\n");
-                            break;
-                        case 2: {
-                            sendMessage(new_socket, "Enter 'from', 'to', and 'weight' for the edge:\n");
-                            read(new_socket, buffer, sizeof(buffer)); // Mutable buffer
-                            int from, to, weight;
-                            sscanf(buffer, "%d %d %d", &from, &to, &weight);
-                            currentGraph.addEdge(from, to, weight);
-                            sendMessage(new_socket, "Edge added successfully!\n");
-                            break;
-                        }
-                        case 3: {
-                            sendMessage(new_socket, "Enter 'from' and 'to' of the edge to remove:\n");
-                            read(new_socket, buffer, sizeof(buffer)); // Mutable buffer
-                            int from, to;
-                            sscanf(buffer, "%d %d", &from, &to);
-                            currentGraph.removeEdge(from, to);
-                            sendMessage(new_socket, "Edge removed successfully!\n");
-                            break;
-                        }
-                        default:
-                            sendMessage(new_socket, "Invalid choice. Please try again.\n");
-                    }
+    // Replies for one connection on their way from stage 3 to stage 1
+    struct Outgoing {
+        std::string data;
+        bool close = false;  // The connection is finished once data is written
+    };
+
+    using RequestHandle = ObjectPool<PipelineRequest, PipelineRequest::Reset>::Handle;
+
+    ObjectPool<PipelineRequest, PipelineRequest::Reset> requests;  // Acquired by stage 1; declared first so it outlives the stages
+    JobManager jobs;                        // Used by stage 3, so it outlives the stages too
+    ActiveObject stage2; // Route requests to their graph's shard
+    std::mutex stage3Mtx; // Serializes submissions to stage 3 from stage 2 and the shards
+    ActiveObject stage3; // Compute MST, pathfinding and reply
+    GraphRegistry graphs; // Shards publish new versions, stage 3 reads snapshots
+
+    std::unordered_map<int, GraphRegistry::Handle> sessionGraphs;  // Owned by stage 2
+
+    // Owned by stage 3: each connection's requests not answered yet, in arrival order, and
+    // the replies gathered since they were last handed to stage 1
+    std::unordered_map<int, std::deque<RequestHandle>> waiting;
+    std::unordered_map<int, Outgoing> replies;
+    std::size_t repliesSize = 0;
+
+    std::mutex outboxMtx;
+    std::unordered_map<int, Outgoing> outbox;  // Handed over by stage 3, guarded by outboxMtx
+    int wakeFd = -1;                           // eventfd stage 3 raises when outbox fills
+
+    int epoll_fd = -1;
+    std::unordered_map<int, Connection> connections;
+    std::atomic<long long> openConnections{0};  // connections.size(), readable from any thread
+    int connectionsGauge = -1;
+    const int acceptedMetric = Metrics::counter("connections.accepted");
 
-                    // Start Stage 3 (Calculations like MST)
-                    stage3.submit([new_socket, this, choice]() {
-                        std::cout << "Processing Stage 3: Calculation (MST, Pathfinding, etc.) for client " << new_socket << std::endl;
-
-                        switch (choice) {
-                            case 4: {
-                                int totalWeight = currentGraph.getTotalWeight();
-                                sendMessage(new_socket, "Total weight of MST: " + std::to_string(totalWeight) + "\n");
-                                break;
-                            }
-                            case 5: {
-                                sendMessage(new_socket, "Enter 'start' and 'end' vertices for the longest path:\n");
-                                char buffer[1024];
-                                read(new_socket, buffer, sizeof(buffer));
-                                int start, end;
-                                sscanf(buffer, "%d %d", &start, &end);
-                                int longestPath = currentGraph.getLongestPath(start, end);
-                                sendMessage(new_socket, "Longest path: " + std::to_string(longestPath) + "\n");
-                                break;
-                            }
-                            case 6: {
-                                sendMessage(new_socket, "Enter 'start' and 'end' vertices for the shortest path:\n");
-                                char buffer[1024];
-                                read(new_socket, buffer, sizeof(buffer));
-                                int start, end;
-                                sscanf(buffer, "%d %d", &start, &end);
-                                int shortestPath = currentGraph.getShortestPath(start, end);
-                                sendMessage(new_socket, "Shortest path: " + std::to_string(shortestPath) + "\n");
-                                break;
-                            }
-                            case 7: {
-                                double avgDistance = currentGraph.getAverageDistance();
-                                sendMessage(new_socket, "Average distance: " + std::to_string(avgDistance) + "\n");
-                                break;
-                            }
-                            case 8:
-                                sendMessage(new_socket, "MST Edges:\n");
-                                currentGraph.printMST();
-                                break;
-                            case 9:
-                                sendMessage(new_socket, "Goodbye!\n");
-                                close(new_socket);
-                                return;
-                            default:
-                                sendMessage(new_socket, "Invalid choice. Please try again.\n");
-                        }
-
-                        // Send the menu again for the next operation
-                        sendMessage(new_socket, menu);
-                    });
-                });
+    void forward(RequestHandle request) {
+        stage2.submit([this, request = std::move(request)]() mutable {
+            try {
+                applyChange(*request);
+            } catch (const std::exception& error) {
+                failRequest(*request, error.what());
             }
+            // Start Stage 3 (Calculations like MST)
+            std::lock_guard<std::mutex> lock(stage3Mtx);
+            stage3.submit([this, request = std::move(request)]() mutable { arrive(std::move(request)); });
         });
     }
+
+    // Completion for the request's mutation: record the outcome on the shard, then have
+    // stage 3 answer what was waiting for it
+    GraphRegistry::Completion completion(PipelineRequest& request) {
+        request.applied = std::make_shared<Applied>();
+        return [this, fd = request.fd, applied = request.applied](std::exception_ptr error) {
+            applied->error = error;
+            applied->done.store(true, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(stage3Mtx);
+            stage3.submit([this, fd]() { advance(fd); });
+        };
+    }
+
+    // Answer a request whose routing threw (say, out of memory) with the error alone
+    static void failRequest(PipelineRequest& request, const std::string& error) {
+        request.applied.reset();
+        request.reply.clear();
+        if (request.kind == PipelineRequest::Binary) {
+            BinaryProtocol::appendError(request.reply, request.frame.opcode, "Request failed: " + error);
+        } else {
+            request.kind = PipelineRequest::Notice;
+            request.reply = "Request failed: " + error + "\n";
+        }
+    }
+
+    // A request can be answered once it has no mutation or the mutation is done
+    static bool isReady(const PipelineRequest& request) {
+        return !request.applied || request.applied->done.load(std::memory_order_acquire);
+    }
+
+    // True if the request's mutation ran, else error holds why it did not
+    static bool succeeded(const PipelineRequest& request, std::string& error) {
+        if (!request.applied || !request.applied->error) return true;
+        try {
+            std::rethrow_exception(request.applied->error);
+        } catch (const std::exception& failure) {
+            error = std::string("Request failed: ") + failure.what();
+        } catch (...) {
+            error = "Request failed";
+        }
+        return false;
+    }
+
+    GraphRegistry::Handle& sessionGraph(int fd) {
+        auto it = sessionGraphs.find(fd);
+        if (it == sessionGraphs.end()) {
+            it = sessionGraphs.emplace(fd, graphs.open(GraphRegistry::DEFAULT_GRAPH)).first;
+        }
+        return it->second;
+    }
+
+    // Stage 2 for binary frames: registry commands run here, mutations go to the shard
+    void routeFrame(PipelineRequest& request) {
+        using namespace BinaryProtocol;
+        Command& command = request.frame;
+        if (!command.error.empty()) {
+            appendError(request.reply, command.opcode, command.error);
+        } else if (command.opcode == CLOSE) {
+            appendOk(request.reply, command.opcode);
+        } else if (command.opcode == STATS) {
+            appendStats(request.reply);
+        } else if (command.isRegistry()) {
+            runRegistryCommand(graphs, sessionGraph(request.fd), command, request.reply);
+        } else if (command.isJob() && !command.isSubmit()) {
+            // Needs no graph; answered by stage 3
+        } else {
+            GraphRegistry::Handle& current = sessionGraph(request.fd);
+            std::string notice;
+            if (!checkCurrentGraph(graphs, current, notice)) {
+                appendError(request.reply, command.opcode, notice);
+            } else if (command.isMutation()) {
+                graphs.update(current, std::move(command.mutation), completion(request));
+                if (!command.isFileCommand()) appendOk(request.reply, command.opcode);  // Answered in stage 3
+            }
+            request.graph = current;  // Queries are answered by stage 3
+        }
+        if (command.opcode == CLOSE) sessionGraphs.erase(request.fd);
+    }
+
+    // Stage 2: pick the request's graph and start its mutation on the owning shard
+    void applyChange(PipelineRequest& request) {
+        if (request.kind == PipelineRequest::Disconnect || request.kind == PipelineRequest::Refuse) {
+            sessionGraphs.erase(request.fd);
+        } else if (request.kind == PipelineRequest::Binary) {
+            routeFrame(request);
+        } else if (request.kind == PipelineRequest::Command && request.validArgs) {
+            auto it = sessionGraphs.find(request.fd);
+            if (it == sessionGraphs.end()) {
+                it = sessionGraphs.emplace(request.fd, graphs.open(GraphRegistry::DEFAULT_GRAPH)).first;
+            }
+            GraphRegistry::Handle& current = it->second;
+            const int* args = request.args;
+
+            bool usesGraph = (request.choice >= 1 && request.choice <= 8) || (request.choice >= 13 && request.choice <= 15) ||
+                             request.choice == 17 || request.choice == 18 || request.choice == 22;
+            if (usesGraph && !checkCurrentGraph(graphs, current, request.reply)) {
+                request.kind = PipelineRequest::Notice;  // Answered with the notice only
+            }
+            request.graph = current;
+            switch (request.kind == PipelineRequest::Command ? request.choice : 0) {
+                case 1:
+                    if (!Graph::isValidVertexCount(args[0])) {
+                        request.reply = invalidVertexCount();
+                        break;
+                    }
+                    graphs.reset(current, args[0], completion(request));
+                    request.reply = "Graph created successfully!\n";
+                    break;
+                case 2:
+                    graphs.update(current, [u = args[0], v = args[1], w = args[2]](Graph& graph) {
+                        graph.addEdge(u, v, w);
+                    }, completion(request));
+                    request.reply = "Edge added successfully!\n";
+                    break;
+                case 3:
+                    graphs.update(current, [u = args[0], v = args[1]](Graph& graph) {
+                        graph.removeEdge(u, v);
+                    }, completion(request));
+                    request.reply = "Edge removed successfully!\n";
+                    break;
+                case 9:
+                    sessionGraphs.erase(it);
+                    break;
+                case 10:
+                    request.reply = createNamedGraph(graphs, current, request.name, args[0]);
+                    break;
+                case 11:
+                    request.reply = openNamedGraph(graphs, current, request.name);
+                    break;
+                case 12:
+                    request.reply = dropNamedGraph(graphs, current, request.name);
+                    break;
+                case 13: {
+                    std::string path;
+                    if (!resolveDataPath(request.name, path, request.reply)) {
+                        request.reply += "\n";
+                        request.kind = PipelineRequest::Notice;
+                        break;
+                    }
+                    request.load = std::make_shared<EdgeLoader::LoadResult>();
+                    graphs.update(current, EdgeLoader::loadInto(path, request.load), completion(request));
+                    break;
+                }
+                case 14:
+                case 15: {
+                    std::string path;
+                    if (!resolveDataPath(request.name, path, request.reply)) {
+                        request.reply += "\n";
+                        request.kind = PipelineRequest::Notice;
+                        break;
+                    }
+                    // Saves run on the shard too, so they see exactly the writes queued before them
+                    request.snapshot = std::make_shared<GraphSnapshot::Result>();
+                    graphs.update(current, request.choice == 14
+                        ? GraphSnapshot::saveFrom(path, request.snapshot)
+                        : GraphSnapshot::loadInto(path, request.snapshot), completion(request));
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Stage 3: queue the request behind its connection's unanswered ones
+    void arrive(RequestHandle request) {
+        int fd = request->fd;
+        waiting[fd].push_back(std::move(request));
+        advance(fd);
+    }
+
+    // Stage 3: answer the connection's requests in order, up to the first whose mutation is
+    // still on its shard; that mutation's completion brings stage 3 back here
+    void advance(int fd) {
+        auto it = waiting.find(fd);
+        if (it != waiting.end()) {
+            std::deque<RequestHandle>& queue = it->second;
+            Outgoing& reply = replies[fd];
+            std::size_t before = reply.data.size();
+            while (!queue.empty() && isReady(*queue.front())) {
+                RequestHandle request = std::move(queue.front());
+                queue.pop_front();
+                try {
+                    respond(*request, reply);
+                } catch (const std::exception& error) {
+                    // The reply may be half-written, so the connection cannot go on; stage 1
+                    // sees the shutdown and retires the connection as usual
+                    std::cerr << "Reply to client " << fd << " failed: " << error.what() << std::endl;
+                    shutdown(fd, SHUT_RDWR);
+                }
+            }
+            repliesSize += reply.data.size() - before;
+            if (reply.close) waiting.erase(it);  // Its last request was answered
+        }
+        if (repliesSize >= BUFFER_SIZE || stage3.queueDepth() == 0) deliver();
+    }
+
+    // Stage 3: hand the gathered replies to stage 1, waking it unless earlier ones still wait
+    void deliver() {
+        if (replies.empty()) return;
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(outboxMtx);
+            wake = outbox.empty();
+            if (wake) {
+                outbox.swap(replies);
+            } else {
+                for (auto& entry : replies) {
+                    Outgoing& posted = outbox[entry.first];
+                    posted.data += entry.second.data;
+                    posted.close = posted.close || entry.second.close;
+                }
+            }
+        }
+        replies.clear();
+        repliesSize = 0;
+        if (wake) {
+            std::uint64_t one = 1;
+            ssize_t written = write(wakeFd, &one, sizeof(one));
+            (void)written;  // Only fails if the counter is already huge, which still wakes stage 1
+        }
+    }
+
+    // Stage 3 for binary frames
+    void respondFrame(const PipelineRequest& request, Outgoing& reply) {
+        Metrics::ScopedTimer timer(BinaryProtocol::opcodeMetric(request.frame.opcode), request.received);
+        std::string& out = reply.data;
+        std::string error;
+        if (!succeeded(request, error)) {
+            BinaryProtocol::appendError(out, request.frame.opcode, error);
+        } else if (!request.reply.empty()) {
+            out += request.reply;
+        } else if (request.frame.isJob()) {
+            BinaryProtocol::runJobCommand(jobs, request.graph, request.frame, out);
+        } else {
+            BinaryProtocol::answerQuery(request.frame, *request.graph->store.snapshot(), out);
+        }
+        if (request.frame.opcode == BinaryProtocol::CLOSE) reply.close = true;
+    }
+
+    // Stage 3: calculations and every reply to the client
+    void respond(const PipelineRequest& request, Outgoing& reply) {
+        std::string& out = reply.data;
+        if (request.kind == PipelineRequest::Disconnect) {
+            reply.close = true;  // The peer may only have shut down its sending side
+            return;
+        }
+        if (request.kind == PipelineRequest::Binary) {
+            respondFrame(request, reply);
+            return;
+        }
+        if (request.kind == PipelineRequest::Refuse) {
+            out += request.reply;
+            reply.close = true;
+            return;
+        }
+        if (request.kind == PipelineRequest::Prompt) {
+            out += promptFor(request.choice);
+            return;
+        }
+
+        Metrics::ScopedTimer timer(commandMetric(textMetrics, request.choice), request.received);
+        if (!request.validArgs || request.kind == PipelineRequest::Notice) {
+            out += request.validArgs ? request.reply : "Invalid input. Please try again.\n";
+            out += menu;
+            return;
+        }
+
+        std::string error;
+        if (!succeeded(request, error)) {
+            out += error + "\n";
+            out += menu;
+            return;
+        }
+        GraphStore& currentGraph = request.graph->store;
+        switch (request.choice) {
+            case 1:
+            case 2:
+            case 3:
+            case 10:
+            case 11:
+            case 12:
+                out += request.reply;
+                break;
+            case 4: {
+                long long totalWeight = currentGraph.snapshot()->getMSTStats().totalWeight;
+                out += "Total weight of MST: " + std::to_string(totalWeight) + "\n";
+                break;
+            }
+            case 5: {
+                // A tree has exactly one path between two vertices
+                TreePath path = timedTreePath(*currentGraph.snapshot(), request.args[0], request.args[1]);
+                out += formatTreePath("Longest path", request.args[0], request.args[1], path);
+                break;
+            }
+            case 6: {
+                TreePath path = timedTreePath(*currentGraph.snapshot(), request.args[0], request.args[1]);
+                out += formatTreePath("Shortest path", request.args[0], request.args[1], path);
+                break;
+            }
+            case 7: {
+                MSTStats stats = currentGraph.snapshot()->getMSTStats();
+                out += "Average distance: " + std::to_string(stats.averageDistance) +
+                       " (longest: " + std::to_string(stats.diameter) +
+                       ", shortest: " + std::to_string(stats.shortestDistance) + ")\n";
+                break;
+            }
+            case 8:
+                out += "MST Edges:\n" + formatMST(*currentGraph.snapshot());
+                break;
+            case 13:
+                out += EdgeLoader::describe(*request.load, request.name) + "\n";
+                break;
+            case 14:
+            case 15:
+                out += GraphSnapshot::describe(*request.snapshot, request.name, request.choice == 14) + "\n";
+                break;
+            case 16:
+                out += Metrics::report();
+                break;
+            case 17:
+                out += submitMSTJob(jobs, request.graph, request.name, request.args[0]);
+                break;
+            case 18:
+                out += submitPathJob(jobs, request.graph, request.args[0], request.args[1], request.args[2]);
+                break;
+            case 19:
+                out += jobStatus(jobs, request.args[0]);
+                break;
+            case 20:
+                out += takeJobResult(jobs, request.args[0]);
+                break;
+            case 21:
+                out += cancelJob(jobs, request.args[0]);
+                break;
+            case 22:
+                out += formatForest(timedForest(*currentGraph.snapshot()));
+                break;
+            case 9:
+                out += "Goodbye!\n";
+                reply.close = true;
+                return;
+            default:
+                out += "Invalid choice. Please try again.\n";
+        }
+
+        // Send the menu again for the next operation
+        out += menu;
+    }
+
+    // Stage 1: turn one line into a request, or into a prompt for the request's arguments;
+    // returns true if the line asked to exit, judged by the same parse stage 3 answers
+    bool parseLine(int fd, Connection& connection, const std::string& line) {
+        RequestHandle request = requests.acquire();
+        request->fd = fd;
+        request->received = std::chrono::steady_clock::now();
+
+        if (connection.pendingChoice == 0) {
+            if (parseInts(line, &request->choice, 1) != 1) request->choice = -1;
+            if (promptFor(request->choice) != nullptr) {
+                connection.pendingChoice = request->choice;
+                request->kind = PipelineRequest::Prompt;
+            }
+        } else {
+            request->choice = connection.pendingChoice;
+            connection.pendingChoice = 0;
+            if (request->choice == 17) {
+                std::size_t end = parseWord(line, request->name);
+                request->validArgs = end > 0;
+                if (end > 0) parseInts(line.substr(end), request->args, 1);  // The timeout is optional
+            } else if (request->choice == 18) {
+                request->validArgs = parseInts(line, request->args, 3) >= 2;
+            } else if (request->choice >= 19) {
+                request->validArgs = parseInts(line, request->args, 1) == 1;
+            } else if (request->choice >= 13) {
+                request->name = trimmed(line);
+                request->validArgs = !request->name.empty();
+            } else if (request->choice >= 10) {
+                std::size_t end = parseWord(line, request->name);
+                request->validArgs = end > 0 && (request->choice != 10 || parseInts(line.substr(end), request->args, 1) == 1);
+            } else {
+                int needed = argumentCount(request->choice);
+                request->validArgs = parseInts(line, request->args, needed) == needed;
+            }
+        }
+        bool exiting = request->kind == PipelineRequest::Command && request->choice == 9;
+        forward(std::move(request));
+        return exiting;
+    }
+
+    // Stage 1 for binary connections: decode every complete frame straight out of the input
+    // buffer; returns false once the connection was handed over for closing
+    bool parseFrames(int fd, Connection& connection) {
+        std::size_t offset = 0;
+        BinaryProtocol::Frame frame;
+        int found;
+        while ((found = BinaryProtocol::nextFrame(connection.input, offset, frame)) != 0) {
+            RequestHandle request = requests.acquire();
+            request->kind = PipelineRequest::Binary;
+            request->fd = fd;
+            request->received = std::chrono::steady_clock::now();
+            if (found < 0) {
+                request->frame.opcode = BinaryProtocol::CLOSE;
+                request->frame.error = "Frame too large";
+            } else {
+                request->frame = BinaryProtocol::decode(frame);
+            }
+            bool closing = request->frame.opcode == BinaryProtocol::CLOSE;
+            forward(std::move(request));
+            if (closing) {
+                retire(fd, connection, true);  // Stage 3 sends the last reply
+                return false;
+            }
+        }
+        connection.input.erase(0, offset);
+        return true;
+    }
+
+    // Stop reading from the connection; unless a request that ends it (exit, CLOSE) is
+    // already on its way, tell stage 3 the peer left so it sends the last reply
+    void retire(int fd, Connection& connection, bool sayGoodbye) {
+        connection.retired = true;
+        if (!sayGoodbye) {
+            RequestHandle request = requests.acquire();
+            request->kind = PipelineRequest::Disconnect;
+            request->fd = fd;
+            forward(std::move(request));
+        }
+    }
+
+    // The peer is gone: leave the epoll set and drop unsent output. The descriptor stays
+    // open until stage 3 sent the last reply.
+    void breakConnection(int fd, Connection& connection) {
+        if (connection.broken) return;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        connection.broken = true;
+        connection.output.clear();
+        if (!connection.retired) retire(fd, connection, false);
+    }
+
+    // Write what the socket takes, then close the connection if stage 3 is done with it and
+    // nothing is left to send, or else register the events it now waits for
+    void settle(int fd, Connection& connection) {
+        if (!connection.broken && !flushOutput(fd, connection.output)) breakConnection(fd, connection);
+        if (connection.closing && connection.output.empty()) {
+            if (!connection.broken) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            connections.erase(fd);
+            openConnections.store(static_cast<long long>(connections.size()), std::memory_order_relaxed);
+            return;
+        }
+        if (connection.broken) return;
+
+        uint32_t wanted = 0;
+        if (!connection.output.empty()) wanted |= EPOLLOUT;
+        if (!connection.retired && connection.output.size() < MAX_OUTPUT_BACKLOG) wanted |= EPOLLIN | EPOLLRDHUP;
+        if (wanted != connection.armed) {
+            epoll_event ev{};
+            ev.events = wanted;
+            ev.data.fd = fd;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+            connection.armed = wanted;
+        }
+    }
+
+    // Move the replies stage 3 handed over onto their connections. The eventfd is drained
+    // before the outbox is taken, so a hand-off racing with this raises it again.
+    void collectReplies() {
+        std::uint64_t count;
+        ssize_t drained = read(wakeFd, &count, sizeof(count));
+        (void)drained;
+        std::unordered_map<int, Outgoing> posted;
+        {
+            std::lock_guard<std::mutex> lock(outboxMtx);
+            posted.swap(outbox);
+        }
+        for (auto& entry : posted) {
+            auto it = connections.find(entry.first);
+            if (it == connections.end()) continue;
+            Connection& connection = it->second;
+            if (!connection.broken) connection.output += entry.second.data;
+            connection.closing = connection.closing || entry.second.close;
+            settle(entry.first, connection);
+        }
+    }
+
+    void serveClient(int fd, uint32_t events) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) return;
+        Connection& connection = it->second;
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            breakConnection(fd, connection);
+        } else if ((events & (EPOLLIN | EPOLLRDHUP)) && !connection.retired) {
+            readClient(fd, connection);
+        }
+        settle(fd, connection);
+    }
+
+    void readClient(int fd, Connection& connection) {
+        char buffer[BUFFER_SIZE];
+        bool open = true;
+        std::size_t readLimit = connection.input.size() + MAX_READ_PER_EVENT;
+        while (connection.input.size() < readLimit) {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                connection.input.append(buffer, static_cast<std::size_t>(n));
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) open = false;
+                break;
+            }
+        }
+
+        if (connection.mode == BinaryProtocol::UNDECIDED) {
+            connection.mode = BinaryProtocol::detectMode(connection.input);
+            if (connection.mode == BinaryProtocol::BINARY) {
+                // Nothing is queued for the connection before its first bytes, so answer here
+                connection.input.erase(0, BinaryProtocol::PREAMBLE_SIZE);
+                connection.output.append(BinaryProtocol::PREAMBLE, BinaryProtocol::PREAMBLE_SIZE);
+            } else if (connection.mode == BinaryProtocol::INVALID) {
+                open = false;
+            }
+        }
+        if (connection.mode == BinaryProtocol::BINARY) {
+            if (parseFrames(fd, connection) && !open) retire(fd, connection, false);
+            return;
+        }
+
+        std::string line;
+        while (connection.mode == BinaryProtocol::TEXT && takeLine(connection.input, line)) {
+            if (parseLine(fd, connection, line)) {
+                retire(fd, connection, true);  // Stage 3 says goodbye
+                return;
+            }
+        }
+        if (connection.mode == BinaryProtocol::TEXT && connection.input.size() > MAX_LINE_LENGTH) {
+            RequestHandle request = requests.acquire();
+            request->kind = PipelineRequest::Refuse;
+            request->fd = fd;
+            request->reply = LINE_TOO_LONG;
+            forward(std::move(request));
+            retire(fd, connection, true);  // Stage 3 answers, then the connection closes
+            return;
+        }
+        if (!open) retire(fd, connection, false);
+    }
+
+public:
+    PipelineServer() {
+        stage2.instrument("pipeline.stage2");
+        stage3.instrument("pipeline.stage3");
+        connectionsGauge = Metrics::gauge("connections.open", [this]() { return openConnections.load(); });
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    ~PipelineServer() {
+        Metrics::removeGauge(connectionsGauge);
+        close(wakeFd);
+    }
+
+    // Restore a "[graph=]snapshot" before serving
+    bool preload(const std::string& spec) { return preloadSnapshot(graphs, spec); }
+
+    // Runs stage 1 on the calling thread
+    void run(int server_fd) {
+        epoll_fd = epoll_create1(0);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = server_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &ev);
+        ev.data.fd = wakeFd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+        epoll_event events[64];
+        while (true) {
+            int ready = epoll_wait(epoll_fd, events, 64, -1);
+            if (ready < 0 && errno != EINTR) {
+                perror("epoll_wait");
+                return;
+            }
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd) {
+                    collectReplies();
+                    continue;
+                }
+                if (fd != server_fd) {
+                    serveClient(fd, events[i].events);
+                    continue;
+                }
+                int new_socket;
+                while ((new_socket = accept(server_fd, nullptr, nullptr)) >= 0) {
+                    std::cout << "New client connected!" << std::endl;
+                    Metrics::add(acceptedMetric);
+                    setNonBlocking(new_socket);
+                    Connection& connection = connections[new_socket];
+                    connection = Connection();
+                    openConnections.store(static_cast<long long>(connections.size()), std::memory_order_relaxed);
+
+                    epoll_event clientEv{};
+                    clientEv.events = connection.armed = EPOLLIN | EPOLLRDHUP;
+                    clientEv.data.fd = new_socket;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, new_socket, &clientEv);
+                    connection.output = menu;  // Nothing is queued for a fresh connection yet
+                    settle(new_socket, connection);
+                }
+            }
+        }
+    }
 };
 
 // This will handle incoming requests asynchronously
-int main() {
-    int server_fd, new_socket;
+// Usage: ./pipeline_server [--preload [graph=]snapshot]... [--max-vertices N] [--data-dir DIR] [--metrics-port N]
+// --max-vertices bounds every graph clients create or load (default Graph::DEFAULT_VERTEX_LIMIT);
+// --data-dir holds the files clients load and save (default the working directory)
+int main(int argc, char* argv[]) {
+    int server_fd;
     struct sockaddr_in address;
-    int addrlen = sizeof(address);
 
     // Creating socket file descriptor
     server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(8080);
+    address.sin_port = htons(PORT);
 
     // Binding and listening
-    bind(server_fd, (struct sockaddr *)&address, sizeof(address));
-    listen(server_fd, 3);
+    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        perror("bind failed");
+        return 1;
+    }
+    listen(server_fd, SOMAXCONN);
+    setNonBlocking(server_fd);
 
     PipelineServer pipelineServer;
-
-    std::cout << "Server listening on port 8080\n";
-
-    while (true) {
-        new_socket = accept(server_fd, (struct sockaddr *)&address, (socklen_t*)&addrlen);
-        std::cout << "New client connected!" << std::endl;
-        pipelineServer.handleRequest(new_socket);  // Each request handled by the pipeline
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--preload" && i + 1 < argc) {
+            if (!pipelineServer.preload(argv[++i])) return 1;
+        } else if (std::string(argv[i]) == "--max-vertices" && i + 1 < argc) {
+            Graph::setVertexLimit(std::atoi(argv[++i]));
+        } else if (std::string(argv[i]) == "--data-dir" && i + 1 < argc) {
+            setDataDir(argv[++i]);
+        } else if (std::string(argv[i]) == "--metrics-port" && i + 1 < argc) {
+            if (!Metrics::startEndpoint(std::atoi(argv[++i]))) {
+                perror("metrics endpoint");
+                return 1;
+            }
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--preload [graph=]snapshot]... [--max-vertices N] [--data-dir DIR] [--metrics-port N]\n";
+            return 1;
+        }
     }
 
+    std::cout << "Server listening on port " << PORT << "\n";
+    pipelineServer.run(server_fd);  // Stage 1 runs on the main thread
+
     return 0;
 };
 //make
 // ./pipeline_server
 // Server listening on port 8080
 //open a new terminal
-//nc localhost 8080
\ No newline at end of file
+//nc localhost 8080
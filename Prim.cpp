@@ -1,26 +1,78 @@
 #include "prim.hpp"
+#include "indexed_heap.hpp"
 #include <iostream>
-#include <queue>
 #include <limits>
 
-std::vector<std::tuple<int, int, int>> PrimMST::computeMST(Graph& graph) {
+PrimMST::PrimMST(bool verbose, const CancelToken* cancel) : verbose(verbose), cancel(cancel) {}
+
+std::vector<std::tuple<int, int, int>> PrimMST::computeMST(const Graph& graph) {
     int V = graph.V;
-    std::vector<int> key(V, std::numeric_limits<int>::max());
     std::vector<int> parent(V, -1);
     std::vector<bool> inMST(V, false);
-    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> pq;
-
-    pq.push({0, 0});
-    key[0] = 0;
+    IndexedDaryHeap<int> pq(V);
 
     std::vector<std::tuple<int, int, int>> mstEdges;
-    int totalWeight = 0;
+    long long totalWeight = 0;
+    if (V == 0) return mstEdges;
+
+    // Grow a tree from every vertex no earlier tree reached, giving a spanning forest
+    std::size_t steps = 0;
+    for (int start = 0; start < V; ++start) {
+        if (inMST[start]) continue;
+        pq.push(start, 0);
+        while (!pq.empty()) {
+            if (CancelToken::poll(cancel, ++steps)) break;
+            int key = pq.key(pq.top());
+            int u = pq.pop();
+            inMST[u] = true;
+
+            if (parent[u] != -1) {
+                mstEdges.push_back({key, parent[u], u});
+                totalWeight += key;
+
+                // Print the selected edge
+                if (verbose) std::cout << "Prim: Edge: " << parent[u] << " -- " << u << " (weight: " << key << ")\n";
+            }
+
+            // Relax only the edges incident to u
+            graph.forEachNeighbor(u, [&](int v, int weight) {
+                if (!inMST[v] && pq.pushOrDecrease(v, weight)) {
+                    parent[v] = u;
+                }
+            });
+        }
+        if (!pq.empty()) break;  // Cancelled
+    }
+
+    if (verbose) std::cout << "Prim's Total Weight: " << totalWeight << std::endl;
+    return mstEdges;
+}
+
+std::vector<std::tuple<int, int, int>> PrimMST::computeDenseMST(const Graph& graph) {
+    const int INF = std::numeric_limits<int>::max();
+    int V = graph.V;
+    std::vector<int> key(V, INF);
+    std::vector<int> parent(V, -1);
+    std::vector<bool> inMST(V, false);
 
-    while (!pq.empty()) {
-        int u = pq.top().second;
-        pq.pop();
+    std::vector<std::tuple<int, int, int>> mstEdges;
+    long long totalWeight = 0;
+    if (V == 0) return mstEdges;
 
-        if (inMST[u]) continue;
+    int nextStart = 0;  // Every vertex below it is in some tree already
+    for (int step = 0; step < V; ++step) {
+        if (CancelToken::check(cancel)) break;  // Every step scans all V vertices anyway
+        // Linear scan for the cheapest vertex outside the tree
+        int u = -1;
+        for (int v = 0; v < V; ++v) {
+            if (!inMST[v] && key[v] != INF && (u == -1 || key[v] < key[u])) u = v;
+        }
+        if (u == -1) {
+            // The current tree is complete; start the next one of the forest at the first
+            // vertex outside every tree so far
+            while (inMST[nextStart]) ++nextStart;
+            u = nextStart;
+        }
         inMST[u] = true;
 
         if (parent[u] != -1) {
@@ -28,24 +80,17 @@ std::vector<std::tuple<int, int, int>> PrimMST::computeMST(Graph& graph) {
             totalWeight += key[u];
 
             // Print the selected edge
-            std::cout << "Prim: Edge: " << parent[u] << " -- " << u << " (weight: " << key[u] << ")\n";
+            if (verbose) std::cout << "Prim: Edge: " << parent[u] << " -- " << u << " (weight: " << key[u] << ")\n";
         }
 
-        // Traverse all edges connected to u
-        for (const auto& edge : graph.getEdges()) {
-            int weight, v1, v2;
-            std::tie(weight, v1, v2) = edge;
-
-            int v = (u == v1) ? v2 : v1;
-
+        graph.forEachNeighbor(u, [&](int v, int weight) {
             if (!inMST[v] && weight < key[v]) {
                 key[v] = weight;
                 parent[v] = u;
-                pq.push({key[v], v});
             }
-        }
+        });
     }
 
-    std::cout << "Prim's Total Weight: " << totalWeight << std::endl;
+    if (verbose) std::cout << "Prim's Total Weight: " << totalWeight << std::endl;
     return mstEdges;
 }
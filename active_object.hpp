@@ -0,0 +1,152 @@
+#ifndef ACTIVE_OBJECT_HPP
+#define ACTIVE_OBJECT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include "inline_task.hpp"
+#include "metrics.hpp"
+#include "spsc_ring.hpp"
+
+// Active Object class to manage async tasks
+// Tasks travel through a bounded lock-free SPSC ring, so each ActiveObject accepts
+// submissions from a single producer thread. A full ring makes submit() wait, pushing
+// backpressure up the pipeline. Ring slots are preallocated, cache-line sized and hold the
+// task's callable in place (see InlineTask), so submitting a task that captures up to
+// TASK_CAPACITY bytes allocates nothing. An idle worker spins briefly, then yields, and only
+// then takes the mutex to park; producers only take it to wake a parked worker.
+// Once instrument() names it, the object records how long tasks wait in the ring, how long
+// they run and how deep the ring is when they arrive.
+class ActiveObject {
+public:
+    static const std::size_t TASK_CAPACITY = 40;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct alignas(64) Task {
+        InlineTask<TASK_CAPACITY> run;
+        Clock::time_point queued;  // Only stamped while instrumented
+    };
+
+    // Empty polls before an idle worker yields, and yields before it parks
+    static const int SPIN_POLLS = 128;
+    static const int YIELD_POLLS = 16;
+
+    SpscRing<Task> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> done{false};
+    std::atomic<bool> instrumented{false};
+    int waitMetric = -1, serviceMetric = -1, depthMetric = -1, depthGauge = -1;
+    std::thread worker;
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    void run() {
+        Task task;
+        int idlePolls = 0;
+        while (true) {
+            if (tasks.tryPop(task)) {
+                idlePolls = 0;
+                if (instrumented.load(std::memory_order_acquire)) {
+                    Clock::time_point start = Clock::now();
+                    if (task.queued != Clock::time_point()) {
+                        Metrics::record(waitMetric, static_cast<std::uint64_t>(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(start - task.queued).count()));
+                    }
+                    task.run();
+                    Metrics::record(serviceMetric, Metrics::nanosSince(start));
+                } else {
+                    task.run();
+                }
+                task.run = nullptr;
+                continue;
+            }
+            if (done.load(std::memory_order_acquire)) {
+                if (tasks.empty()) return;
+                continue;
+            }
+            ++idlePolls;
+            if (idlePolls <= SPIN_POLLS) {
+                cpuRelax();
+            } else if (idlePolls <= SPIN_POLLS + YIELD_POLLS) {
+                std::this_thread::yield();
+            } else {
+                park();
+                idlePolls = 0;
+            }
+        }
+    }
+
+    void park() {
+        std::unique_lock<std::mutex> lock(mtx);
+        sleeping.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Re-check after announcing the nap so a concurrent submit cannot be missed
+        if (tasks.empty() && !done.load(std::memory_order_seq_cst)) {
+            cv.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(mtx);
+            cv.notify_one();
+        }
+    }
+
+public:
+    explicit ActiveObject(std::size_t capacity = 1024) : tasks(capacity), worker(&ActiveObject::run, this) {}
+    ~ActiveObject() {
+        if (depthGauge >= 0) Metrics::removeGauge(depthGauge);
+        done.store(true, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            cv.notify_all();
+        }
+        worker.join();
+    }
+
+    // Report under "<name>.wait", "<name>.service", "<name>.depth" and "<name>.queue_depth";
+    // call once, before submitting from another thread
+    void instrument(const std::string& name) {
+        waitMetric = Metrics::histogram(name + ".wait");
+        serviceMetric = Metrics::histogram(name + ".service");
+        depthMetric = Metrics::histogram(name + ".depth", Metrics::COUNT);
+        depthGauge = Metrics::gauge(name + ".queue_depth", [this]() { return static_cast<long long>(tasks.size()); });
+        instrumented.store(true, std::memory_order_release);
+    }
+
+    // Enqueue tasks for async execution; waits while the ring is full
+    template <typename Fn>
+    void submit(Fn&& fn) {
+        Task task{InlineTask<TASK_CAPACITY>(std::forward<Fn>(fn)), Clock::time_point()};
+        if (instrumented.load(std::memory_order_relaxed)) {
+            Metrics::record(depthMetric, tasks.size());
+            task.queued = Clock::now();
+        }
+        while (!tasks.tryPush(std::move(task))) {
+            wake();
+            std::this_thread::yield();
+        }
+        wake();
+    }
+
+    std::size_t queueDepth() const { return tasks.size(); }
+};
+
+#endif  // ACTIVE_OBJECT_HPP
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "graph.hpp"
+#include "graph_generators.hpp"
+#include "mst_factory.hpp"
+#include "simd_kernels.hpp"
+
+// MST benchmark: times every MSTFactory algorithm on seeded synthetic graphs, checks that they
+// agree on the total weight and writes the results as CSV and/or JSON for regression tracking.
+// Built with optimization by `make bench`; see usage() for the options.
+
+namespace {
+
+// prim-dense is O(V^2); past this many vertices it only measures the scan
+const int DENSE_VERTEX_LIMIT = 20000;
+
+struct BenchConfig {
+    std::vector<std::string> generators = GraphGenerators::names();
+    std::vector<std::size_t> sizes = {1000, 10000, 100000, 1000000};
+    std::vector<std::string> algorithms = {"prim", "prim-dense", "kruskal", "filter-kruskal", "boruvka",
+                                           "boruvka-parallel"};
+    int warmup = 1;
+    int repetitions = 5;
+    std::uint64_t seed = 42;
+    unsigned numThreads = 0;
+    std::string csvPath, jsonPath;
+};
+
+struct BenchRecord {
+    std::string generator;
+    std::size_t requestedEdges = 0;
+    int vertices = 0;
+    std::size_t edges = 0;
+    double generateSeconds = 0;
+    std::string algorithm;
+    std::vector<double> seconds;  // One per repetition, sorted
+    std::size_t mstEdges = 0;
+    long long weight = 0;
+    bool agrees = true;
+
+    double minimum() const { return seconds.front(); }
+    double median() const {
+        std::size_t n = seconds.size();
+        return n % 2 ? seconds[n / 2] : (seconds[n / 2 - 1] + seconds[n / 2]) / 2;
+    }
+    double mean() const {
+        double sum = 0;
+        for (double s : seconds) sum += s;
+        return sum / seconds.size();
+    }
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<std::string> splitList(const char* text) {
+    std::vector<std::string> items;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Run one algorithm `warmup` times untimed, then `repetitions` times timed
+BenchRecord runAlgorithm(Graph& graph, const std::string& algorithm, const BenchConfig& config) {
+    MSTOptions options;
+    options.numThreads = config.numThreads;
+    options.verbose = false;
+
+    BenchRecord record;
+    record.algorithm = algorithm;
+    for (int i = 0; i < config.warmup; ++i) MSTFactory::computeMST(graph, algorithm, options);
+    for (int i = 0; i < config.repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        auto tree = MSTFactory::computeMST(graph, algorithm, options);
+        record.seconds.push_back(secondsSince(start));
+        if (i == 0) {
+            record.mstEdges = tree.size();
+            for (const auto& edge : tree) record.weight += std::get<0>(edge);
+        }
+    }
+    std::sort(record.seconds.begin(), record.seconds.end());
+    return record;
+}
+
+void printRecord(const BenchRecord& record) {
+    std::cout << std::left << std::setw(10) << record.generator << std::right << std::setw(10) << record.edges
+              << std::setw(10) << record.vertices << "  " << std::left << std::setw(17) << record.algorithm
+              << std::right << std::fixed << std::setprecision(6) << std::setw(11) << record.minimum()
+              << std::setw(11) << record.median() << std::setw(11) << record.mean() << std::setw(16)
+              << record.weight << (record.agrees ? "" : "  MISMATCH") << "\n";
+    std::cout.unsetf(std::ios::fixed);
+}
+
+bool writeCsv(const std::string& path, const std::vector<BenchRecord>& records, const BenchConfig& config) {
+    std::ofstream out(path);
+    out << "generator,requested_edges,vertices,edges,seed,threads,algorithm,repetitions,generate_s,min_s,"
+           "median_s,mean_s,max_s,mst_edges,total_weight,agrees\n";
+    out << std::setprecision(9);
+    for (const auto& r : records) {
+        out << r.generator << ',' << r.requestedEdges << ',' << r.vertices << ',' << r.edges << ','
+            << config.seed << ',' << config.numThreads << ',' << r.algorithm << ',' << r.seconds.size() << ','
+            << r.generateSeconds << ',' << r.minimum() << ',' << r.median() << ',' << r.mean() << ','
+            << r.seconds.back() << ',' << r.mstEdges << ',' << r.weight << ',' << (r.agrees ? 1 : 0) << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool writeJson(const std::string& path, const std::vector<BenchRecord>& records, const BenchConfig& config) {
+    std::ofstream out(path);
+    out << std::setprecision(9);
+    out << "{\n  \"seed\": " << config.seed << ",\n  \"threads\": " << config.numThreads
+        << ",\n  \"warmup\": " << config.warmup << ",\n  \"repetitions\": " << config.repetitions
+        << ",\n  \"results\": [";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const BenchRecord& r = records[i];
+        out << (i ? ",\n" : "\n") << "    {\"generator\": \"" << r.generator << "\", \"requested_edges\": "
+            << r.requestedEdges << ", \"vertices\": " << r.vertices << ", \"edges\": " << r.edges
+            << ", \"algorithm\": \"" << r.algorithm << "\", \"generate_s\": " << r.generateSeconds
+            << ", \"seconds\": [";
+        for (std::size_t j = 0; j < r.seconds.size(); ++j) out << (j ? ", " : "") << r.seconds[j];
+        out << "], \"min_s\": " << r.minimum() << ", \"median_s\": " << r.median() << ", \"mean_s\": " << r.mean()
+            << ", \"mst_edges\": " << r.mstEdges << ", \"total_weight\": " << r.weight
+            << ", \"agrees\": " << (r.agrees ? "true" : "false") << "}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--generators g,...] [--sizes n,...] [--algorithms a,...]\n"
+              << "       [--warmup N] [--reps N] [--seed S] [--threads N] [--simd ISA] [--csv FILE] [--json FILE]\n"
+              << "  Generators: er, grid, rmat, geometric (all by default).\n"
+              << "  Sizes are target edge counts, e.g. 1e3,1e5,1e7 (default 1e3 to 1e6).\n"
+              << "  --simd picks the scan kernels: avx2, sse4 or scalar (default: the best the CPU has).\n"
+              << "  Exits with status 2 when the algorithms disagree on a total weight.\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--generators") == 0 && hasValue) {
+            config.generators = splitList(argv[++i]);
+        } else if (std::strcmp(argv[i], "--sizes") == 0 && hasValue) {
+            config.sizes.clear();
+            for (const std::string& size : splitList(argv[++i])) {
+                config.sizes.push_back(static_cast<std::size_t>(std::max(1.0, std::atof(size.c_str()))));
+            }
+        } else if (std::strcmp(argv[i], "--algorithms") == 0 && hasValue) {
+            config.algorithms = splitList(argv[++i]);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            config.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--reps") == 0 && hasValue) {
+            config.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            config.numThreads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--simd") == 0 && hasValue) {
+            if (!Simd::select(argv[++i])) {
+                std::cerr << "Kernels '" << argv[i] << "' are unknown or unsupported on this CPU\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--csv") == 0 && hasValue) {
+            config.csvPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            config.jsonPath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::cout << "Scan kernels: " << Simd::active() << "\n";
+    std::cout << std::left << std::setw(10) << "generator" << std::right << std::setw(10) << "edges"
+              << std::setw(10) << "vertices" << "  " << std::left << std::setw(17) << "algorithm" << std::right
+              << std::setw(11) << "min s" << std::setw(11) << "median s" << std::setw(11) << "mean s"
+              << std::setw(16) << "total weight" << "\n";
+
+    std::vector<BenchRecord> records;
+    bool allAgree = true;
+    for (const std::string& generator : config.generators) {
+        for (std::size_t size : config.sizes) {
+            auto start = std::chrono::steady_clock::now();
+            GraphGenerators::GeneratedGraph generated;
+            if (!GraphGenerators::generate(generator, size, config.seed, generated)) {
+                std::cerr << "Unknown generator '" << generator << "'\n";
+                return 1;
+            }
+            Graph graph(generated.vertices);
+            graph.addEdges(generated.triples.data(), generated.edgeCount());
+            double generateSeconds = secondsSince(start);
+            std::size_t edges = generated.edgeCount();
+            std::vector<int>().swap(generated.triples);
+
+            std::size_t first = records.size();
+            for (const std::string& algorithm : config.algorithms) {
+                if (algorithm == "prim-dense" && graph.V > DENSE_VERTEX_LIMIT) continue;
+                BenchRecord record = runAlgorithm(graph, algorithm, config);
+                record.generator = generator;
+                record.requestedEdges = size;
+                record.vertices = graph.V;
+                record.edges = edges;
+                record.generateSeconds = generateSeconds;
+                if (record.mstEdges == 0 && graph.V > 1) {
+                    std::cerr << "Unknown algorithm '" << algorithm << "'\n";
+                    return 1;
+                }
+                // Every algorithm must match the first one run on this graph
+                if (records.size() > first) {
+                    record.agrees = record.weight == records[first].weight &&
+                                    record.mstEdges == records[first].mstEdges;
+                }
+                allAgree = allAgree && record.agrees;
+                printRecord(record);
+                records.push_back(std::move(record));
+            }
+        }
+    }
+
+    if (!config.csvPath.empty() && !writeCsv(config.csvPath, records, config)) {
+        std::cerr << "Failed to write '" << config.csvPath << "'\n";
+        return 1;
+    }
+    if (!config.jsonPath.empty() && !writeJson(config.jsonPath, records, config)) {
+        std::cerr << "Failed to write '" << config.jsonPath << "'\n";
+        return 1;
+    }
+    if (!allAgree) {
+        std::cerr << "MST weights disagree between algorithms\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,456 @@
+#include "binary_protocol.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "metrics.hpp"
+#include "mst_factory.hpp"
+#include "server_common.hpp"
+#include "shortest_path.hpp"
+
+namespace BinaryProtocol {
+
+namespace {
+
+std::uint32_t loadU32(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8 |
+           static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+}
+
+// Sequential reads from a payload that never run past its end
+struct Cursor {
+    const char* p;
+    std::size_t left;
+
+    bool u32(std::uint32_t& value) {
+        if (left < 4) return false;
+        value = loadU32(p);
+        p += 4;
+        left -= 4;
+        return true;
+    }
+
+    bool u64(std::uint64_t& value) {
+        std::uint32_t low, high;
+        if (!u32(low) || !u32(high)) return false;
+        value = static_cast<std::uint64_t>(high) << 32 | low;
+        return true;
+    }
+
+    bool i32(int& value) {
+        std::uint32_t raw;
+        if (!u32(raw)) return false;
+        value = static_cast<int>(raw);
+        return true;
+    }
+};
+
+void putU32(std::string& out, std::uint32_t value) {
+    char bytes[4] = {static_cast<char>(value), static_cast<char>(value >> 8), static_cast<char>(value >> 16),
+                     static_cast<char>(value >> 24)};
+    out.append(bytes, 4);
+}
+
+void putU64(std::string& out, std::uint64_t value) {
+    putU32(out, static_cast<std::uint32_t>(value));
+    putU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+void putI32(std::string& out, int value) { putU32(out, static_cast<std::uint32_t>(value)); }
+void putI64(std::string& out, long long value) { putU64(out, static_cast<std::uint64_t>(value)); }
+
+void putF64(std::string& out, double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU64(out, bits);
+}
+
+// Write the response header with a placeholder length; returns where the frame starts
+std::size_t beginResponse(std::string& out, std::uint8_t opcode, Status status) {
+    std::size_t start = out.size();
+    putU32(out, 0);
+    out.push_back(static_cast<char>(opcode));
+    out.push_back(static_cast<char>(status));
+    return start;
+}
+
+void endResponse(std::string& out, std::size_t start) {
+    std::uint32_t length = static_cast<std::uint32_t>(out.size() - start - 4);
+    for (int i = 0; i < 4; ++i) out[start + i] = static_cast<char>(length >> (8 * i));
+}
+
+// Decode count packed little-endian (u, v, weight) triples
+std::shared_ptr<std::vector<int>> decodeTriples(const char* data, std::size_t count) {
+    auto triples = std::make_shared<std::vector<int>>(3 * count);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(triples->data(), data, 12 * count);
+#else
+    for (std::size_t i = 0; i < 3 * count; ++i) (*triples)[i] = static_cast<int>(loadU32(data + 4 * i));
+#endif
+    return triples;
+}
+
+// Refuse a graph larger than the server allows before anything is allocated for it
+bool acceptsVertexCount(std::uint32_t vertices, Command& command) {
+    if (vertices > 0 && vertices <= static_cast<std::uint32_t>(Graph::vertexLimit())) return true;
+    command.error = "Vertex count out of range (1.." + std::to_string(Graph::vertexLimit()) + ")";
+    return false;
+}
+
+const char* const OPCODE_NAMES[MAX_OPCODE + 1] = {
+    "unknown", "create_graph", "add_edge", "remove_edge", "add_edges", "mst_weight", "tree_path", "mst_stats",
+    "get_mst", "shortest_path", "create_named", "open_graph", "drop_graph", "close", "load_file",
+    "save_snapshot", "load_snapshot", "stats", "submit_mst", "submit_shortest_path", "job_status", "job_result",
+    "cancel_job", "forest"};
+
+const int TREE_PATH_TIME = Metrics::histogram("compute.tree_path");
+const int SHORTEST_PATH_TIME = Metrics::histogram("compute.shortest_path");
+
+}  // namespace
+
+Mode detectMode(const std::string& input) {
+    if (input.empty()) return UNDECIDED;
+    if (input[0] != PREAMBLE[0]) return TEXT;
+    std::size_t n = std::min(input.size(), PREAMBLE_SIZE);
+    if (input.compare(0, n, PREAMBLE, n) != 0) return INVALID;
+    return n == PREAMBLE_SIZE ? BINARY : UNDECIDED;
+}
+
+int nextFrame(const std::string& buffer, std::size_t& offset, Frame& frame) {
+    if (buffer.size() - offset < 4) return 0;
+    std::uint32_t length = loadU32(buffer.data() + offset);
+    if (length < 1 || length > MAX_FRAME_SIZE) return -1;
+    if (buffer.size() - offset - 4 < length) return 0;
+    frame.opcode = static_cast<std::uint8_t>(buffer[offset + 4]);
+    frame.payload = buffer.data() + offset + HEADER_SIZE;
+    frame.size = length - 1;
+    offset += 4 + length;
+    return 1;
+}
+
+Command decode(const Frame& frame) {
+    Command command;
+    command.opcode = frame.opcode;
+    Cursor in{frame.payload, frame.size};
+    bool ok = true;
+
+    switch (frame.opcode) {
+        case CREATE_GRAPH: {
+            std::uint32_t vertices = 0;
+            ok = in.u32(vertices);
+            if (ok && !acceptsVertexCount(vertices, command)) return command;
+            int V = static_cast<int>(vertices);
+            command.vertices = V;
+            command.mutation = [V](Graph& graph) { graph = Graph(V); };
+            break;
+        }
+        case ADD_EDGE: {
+            int u = 0, v = 0, weight = 0;
+            ok = in.i32(u) && in.i32(v) && in.i32(weight);
+            command.mutation = [u, v, weight](Graph& graph) { graph.addEdge(u, v, weight); };
+            break;
+        }
+        case REMOVE_EDGE: {
+            int u = 0, v = 0;
+            ok = in.i32(u) && in.i32(v);
+            command.mutation = [u, v](Graph& graph) { graph.removeEdge(u, v); };
+            break;
+        }
+        case ADD_EDGES: {
+            std::uint32_t count = 0;
+            ok = in.u32(count) && in.left == 12ull * count;
+            if (!ok) break;
+            auto triples = decodeTriples(in.p, count);
+            in.left = 0;
+            command.mutation = [triples](Graph& graph) { graph.addEdges(triples->data(), triples->size() / 3); };
+            break;
+        }
+        case TREE_PATH:
+        case SHORTEST_PATH:
+            ok = in.i32(command.args[0]) && in.i32(command.args[1]);
+            break;
+        case CREATE_NAMED: {
+            std::uint32_t vertices = 0;
+            ok = in.u32(vertices);
+            if (ok && !acceptsVertexCount(vertices, command)) return command;
+            command.vertices = static_cast<int>(vertices);
+            command.name.assign(in.p, in.left);
+            in.left = 0;
+            break;
+        }
+        case OPEN_GRAPH:
+        case DROP_GRAPH:
+            command.name.assign(in.p, in.left);
+            in.left = 0;
+            break;
+        case LOAD_FILE: {
+            command.name.assign(in.p, in.left);
+            in.left = 0;
+            ok = !command.name.empty();
+            std::string path;
+            if (ok && !resolveDataPath(command.name, path, command.error)) return command;
+            command.load = std::make_shared<EdgeLoader::LoadResult>();
+            command.mutation = EdgeLoader::loadInto(path, command.load);
+            break;
+        }
+        case LOAD_SNAPSHOT:
+        case SAVE_SNAPSHOT: {
+            command.name.assign(in.p, in.left);
+            in.left = 0;
+            ok = !command.name.empty();
+            std::string path;
+            if (ok && !resolveDataPath(command.name, path, command.error)) return command;
+            command.snapshot = std::make_shared<GraphSnapshot::Result>();
+            command.mutation = command.opcode == SAVE_SNAPSHOT ? GraphSnapshot::saveFrom(path, command.snapshot)
+                                                              : GraphSnapshot::loadInto(path, command.snapshot);
+            break;
+        }
+        case SUBMIT_MST:
+            ok = in.u32(command.timeoutMs);
+            command.name.assign(in.p, in.left);
+            in.left = 0;
+            if (ok && !MSTFactory::isKnown(command.name)) {
+                command.error = "Unknown MST algorithm";
+                return command;
+            }
+            break;
+        case SUBMIT_SHORTEST_PATH:
+            ok = in.u32(command.timeoutMs) && in.i32(command.args[0]) && in.i32(command.args[1]);
+            break;
+        case JOB_STATUS:
+        case JOB_RESULT:
+        case CANCEL_JOB:
+            ok = in.u64(command.jobId);
+            break;
+        case FOREST:
+            ok = in.u32(command.treeLimit);
+            break;
+        case MST_WEIGHT:
+        case MST_STATS:
+        case GET_MST:
+        case CLOSE:
+        case STATS:
+            break;
+        default:
+            command.error = "Unknown opcode";
+            return command;
+    }
+    if (!ok || in.left != 0) {
+        command.mutation = nullptr;
+        command.error = "Malformed payload";
+    }
+    return command;
+}
+
+void answerQuery(const Command& command, const Graph& graph, std::string& out) {
+    if (command.opcode == LOAD_FILE && !command.load->ok) {
+        appendError(out, command.opcode, EdgeLoader::describe(*command.load, command.name));
+        return;
+    }
+    if ((command.opcode == LOAD_SNAPSHOT || command.opcode == SAVE_SNAPSHOT) && !command.snapshot->ok) {
+        bool saving = command.opcode == SAVE_SNAPSHOT;
+        appendError(out, command.opcode, GraphSnapshot::describe(*command.snapshot, command.name, saving));
+        return;
+    }
+    std::size_t start = beginResponse(out, command.opcode, OK);
+    switch (command.opcode) {
+        case MST_WEIGHT: {
+            MSTStats stats = graph.getMSTStats();
+            putI64(out, stats.totalWeight);
+            putU32(out, static_cast<std::uint32_t>(stats.edgeCount));
+            break;
+        }
+        case TREE_PATH: {
+            TreePath path;
+            {
+                Metrics::ScopedTimer timer(TREE_PATH_TIME);
+                path = graph.getTreePath(command.args[0], command.args[1]);
+            }
+            out.push_back(static_cast<char>(path.connected ? 1 : 0));
+            putI64(out, path.length);
+            putI32(out, path.maxEdge);
+            putI32(out, path.minEdge);
+            putU32(out, static_cast<std::uint32_t>(path.edgeCount));
+            break;
+        }
+        case MST_STATS: {
+            MSTStats stats = graph.getMSTStats();
+            putU32(out, static_cast<std::uint32_t>(stats.edgeCount));
+            putI64(out, stats.totalWeight);
+            putI32(out, stats.heaviestEdge);
+            putI32(out, stats.lightestEdge);
+            putI64(out, stats.diameter);
+            putI64(out, stats.shortestDistance);
+            putF64(out, stats.averageDistance);
+            putU64(out, stats.pairCount);
+            break;
+        }
+        case GET_MST: {
+            const auto& tree = graph.getMST();
+            out.reserve(out.size() + 4 + 12 * tree.size());
+            putU32(out, static_cast<std::uint32_t>(tree.size()));
+            for (const auto& edge : tree) {
+                putI32(out, std::get<1>(edge));
+                putI32(out, std::get<2>(edge));
+                putI32(out, std::get<0>(edge));
+            }
+            break;
+        }
+        case SHORTEST_PATH: {
+            Metrics::ScopedTimer timer(SHORTEST_PATH_TIME);
+            putI64(out, ShortestPath::distance(graph, command.args[0], command.args[1]));
+            break;
+        }
+        case FOREST: {
+            SpanningForest forest = timedForest(graph);
+            std::vector<std::size_t> listed = forest.largest(command.treeLimit);
+            putU32(out, static_cast<std::uint32_t>(forest.trees.size()));
+            putU64(out, forest.edgeCount());
+            putI64(out, forest.totalWeight());
+            putU32(out, static_cast<std::uint32_t>(listed.size()));
+            for (std::size_t index : listed) {
+                const ComponentTree& tree = forest.trees[index];
+                putI32(out, tree.root);
+                putU32(out, static_cast<std::uint32_t>(tree.vertices));
+                putU32(out, static_cast<std::uint32_t>(tree.stats.edgeCount));
+                putI64(out, tree.stats.totalWeight);
+                putI32(out, tree.stats.heaviestEdge);
+                putI64(out, tree.stats.diameter);
+                putF64(out, tree.stats.averageDistance);
+            }
+            break;
+        }
+        case LOAD_FILE:
+            putU32(out, static_cast<std::uint32_t>(command.load->vertices));
+            putU64(out, command.load->edges);
+            putU64(out, command.load->skippedLines);
+            break;
+        case LOAD_SNAPSHOT:
+            putU32(out, static_cast<std::uint32_t>(command.snapshot->vertices));
+            putU64(out, command.snapshot->edges);
+            break;
+        case SAVE_SNAPSHOT:
+            putU64(out, command.snapshot->edges);
+            break;
+        default:
+            break;  // Mutations and CLOSE are acknowledged with an empty OK
+    }
+    endResponse(out, start);
+}
+
+void runRegistryCommand(GraphRegistry& graphs, GraphRegistry::Handle& current, const Command& command, std::string& out) {
+    switch (command.opcode) {
+        case CREATE_NAMED: {
+            GraphRegistry::Handle created = graphs.create(command.name, command.vertices);
+            if (!created) {
+                appendError(out, command.opcode, "Invalid name or graph already exists");
+                return;
+            }
+            current = created;
+            appendOk(out, command.opcode);
+            return;
+        }
+        case OPEN_GRAPH: {
+            GraphRegistry::Handle found = graphs.open(command.name);
+            if (!found) {
+                appendError(out, command.opcode, "No such graph");
+                return;
+            }
+            current = found;
+            std::size_t start = beginResponse(out, command.opcode, OK);
+            putU32(out, static_cast<std::uint32_t>(found->store.snapshot()->V));
+            endResponse(out, start);
+            return;
+        }
+        case DROP_GRAPH:
+            if (command.name == GraphRegistry::DEFAULT_GRAPH || !graphs.drop(command.name)) {
+                appendError(out, command.opcode, "No such graph, or it cannot be dropped");
+                return;
+            }
+            if (current && current->name == command.name) current = graphs.open(GraphRegistry::DEFAULT_GRAPH);
+            appendOk(out, command.opcode);
+            return;
+        default:
+            appendError(out, command.opcode, "Not a registry command");
+    }
+}
+
+void runJobCommand(JobManager& jobs, const GraphRegistry::Handle& current, const Command& command, std::string& out) {
+    JobManager::State state;
+    switch (command.opcode) {
+        case SUBMIT_MST:
+        case SUBMIT_SHORTEST_PATH: {
+            JobSpec spec;
+            if (command.opcode == SUBMIT_MST) {
+                spec.algorithm = command.name;
+            } else {
+                spec.kind = JobSpec::SHORTEST_PATH;
+                spec.start = command.args[0];
+                spec.end = command.args[1];
+            }
+            std::uint64_t id = jobs.submit(current, spec, std::chrono::milliseconds(command.timeoutMs));
+            std::size_t start = beginResponse(out, command.opcode, OK);
+            putU64(out, id);
+            endResponse(out, start);
+            return;
+        }
+        case JOB_STATUS: {
+            if (!jobs.status(command.jobId, state)) break;
+            std::size_t start = beginResponse(out, command.opcode, OK);
+            out.push_back(static_cast<char>(state));
+            endResponse(out, start);
+            return;
+        }
+        case JOB_RESULT: {
+            JobResult result;
+            if (!jobs.result(command.jobId, state, result)) break;
+            std::size_t start = beginResponse(out, command.opcode, OK);
+            out.push_back(static_cast<char>(state));
+            if (state == JobManager::DONE) {
+                putI64(out, result.value);
+                putU64(out, result.edges);
+            }
+            endResponse(out, start);
+            return;
+        }
+        case CANCEL_JOB:
+            if (!jobs.cancel(command.jobId)) {
+                appendError(out, command.opcode, "No such job, or it already finished");
+                return;
+            }
+            appendOk(out, command.opcode);
+            return;
+        default:
+            appendError(out, command.opcode, "Not a job command");
+            return;
+    }
+    appendError(out, command.opcode, "No such job");
+}
+
+void appendStats(std::string& out) {
+    std::size_t start = beginResponse(out, STATS, OK);
+    out += Metrics::report();
+    endResponse(out, start);
+}
+
+int opcodeMetric(std::uint8_t opcode) {
+    static const std::vector<int> ids = []() {
+        std::vector<int> all;
+        for (const char* name : OPCODE_NAMES) all.push_back(Metrics::histogram(std::string("command.binary.") + name));
+        return all;
+    }();
+    return ids[opcode <= MAX_OPCODE ? opcode : 0];
+}
+
+void appendOk(std::string& out, std::uint8_t opcode) {
+    endResponse(out, beginResponse(out, opcode, OK));
+}
+
+void appendError(std::string& out, std::uint8_t opcode, const std::string& message) {
+    std::size_t start = beginResponse(out, opcode, ERROR);
+    out += message;
+    endResponse(out, start);
+}
+
+}  // namespace BinaryProtocol
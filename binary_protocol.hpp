@@ -0,0 +1,130 @@
+#ifndef BINARY_PROTOCOL_HPP
+#define BINARY_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "graph.hpp"
+#include "graph_registry.hpp"
+#include "edge_loader.hpp"
+#include "graph_snapshot.hpp"
+#include "job_manager.hpp"
+
+// Length-prefixed binary protocol served next to the text menu.
+// A client opts in by sending PREAMBLE as its very first bytes; the server answers with the
+// same four bytes after the text menu it already sent, so the client skips everything up to
+// the first NUL. From then on both sides exchange frames, all integers little-endian:
+//   request:  u32 length | u8 opcode | payload            (length counts opcode + payload)
+//   response: u32 length | u8 opcode | u8 status | payload
+// Any number of frames may arrive in one segment; responses come back in request order.
+// An error response carries a text message as its payload.
+namespace BinaryProtocol {
+
+const char PREAMBLE[4] = {'\0', 'M', 'S', 'T'};
+const std::size_t PREAMBLE_SIZE = sizeof(PREAMBLE);
+const std::size_t HEADER_SIZE = 5;
+const std::uint32_t MAX_FRAME_SIZE = 64u << 20;  // ~5.5M edges in one ADD_EDGES frame
+
+enum Opcode : std::uint8_t {
+    CREATE_GRAPH = 1,   // u32 vertices (1..Graph::vertexLimit()); replaces the current graph
+    ADD_EDGE = 2,       // i32 u, i32 v, i32 weight
+    REMOVE_EDGE = 3,    // i32 u, i32 v
+    ADD_EDGES = 4,      // u32 count, then count x (i32 u, i32 v, i32 weight)
+    MST_WEIGHT = 5,     // -> i64 total weight, u32 edge count
+    TREE_PATH = 6,      // i32 start, i32 end -> u8 connected, i64 length, i32 max, i32 min, u32 edges
+    MST_STATS = 7,      // -> u32 edges, i64 total, i32 heaviest, i32 lightest, i64 diameter,
+                        //    i64 shortest distance, f64 average distance, u64 pair count;
+                        //    distances are not clamped, so negative edges can make them negative
+    GET_MST = 8,        // -> u32 count, then count x (i32 u, i32 v, i32 weight)
+    SHORTEST_PATH = 9,  // i32 start, i32 end -> i64 distance in the graph, -1 if unreachable,
+                        // -2 if a negative edge leaves it without a shortest path
+    CREATE_NAMED = 10,  // u32 vertices (likewise), name bytes; switches to the new graph
+    OPEN_GRAPH = 11,    // name bytes -> u32 vertices
+    DROP_GRAPH = 12,    // name bytes
+    CLOSE = 13,         // answered, then the connection is closed
+    LOAD_FILE = 14,     // path bytes under the server's data directory; replaces the current
+                        // graph with an edge-list file -> u32 vertices, u64 edges, u64 skipped entries
+    SAVE_SNAPSHOT = 15, // path bytes under the data directory; writes the current graph -> u64 edges
+    LOAD_SNAPSHOT = 16, // path bytes under the data directory; replaces the current graph
+                        // -> u32 vertices, u64 edges
+    STATS = 17,         // -> the server's metrics report as text
+    SUBMIT_MST = 18,    // u32 timeout ms (0 = default), algorithm name bytes; runs in the
+                        // background on the current graph -> u64 job id
+    SUBMIT_SHORTEST_PATH = 19,  // u32 timeout ms, i32 start, i32 end -> u64 job id
+    JOB_STATUS = 20,    // u64 job id -> u8 state (JobManager::State)
+    JOB_RESULT = 21,    // u64 job id -> u8 state, then once done i64 value (MST weight or
+                        // distance, -1 or -2 as for SHORTEST_PATH), u64 MST edges; fetching a
+                        // finished job forgets it
+    CANCEL_JOB = 22,    // u64 job id; an error if the job is unknown or already finished
+    FOREST = 23         // u32 trees to list -> u32 trees, u64 edges, i64 total weight, u32 listed,
+                        // then listed x (i32 root, u32 vertices, u32 edges, i64 weight,
+                        // i32 heaviest, i64 diameter, f64 average distance), largest trees first
+};
+
+const std::uint8_t MAX_OPCODE = FOREST;
+
+enum Status : std::uint8_t { OK = 0, ERROR = 1 };
+
+// A frame located inside the receive buffer; payload points into that buffer
+struct Frame {
+    std::uint8_t opcode = 0;
+    const char* payload = nullptr;
+    std::uint32_t size = 0;
+};
+
+enum Mode { UNDECIDED, TEXT, BINARY, INVALID };
+
+// Classify a connection from its first bytes; BINARY once the whole preamble has arrived
+Mode detectMode(const std::string& input);
+
+// Locate the frame starting at buffer[offset] and advance offset past it. Returns 1 for a
+// frame, 0 if more bytes are needed and -1 for a length the server refuses.
+int nextFrame(const std::string& buffer, std::size_t& offset, Frame& frame);
+
+// A decoded request. Mutations carry the closure the graph's shard will run.
+struct Command {
+    std::uint8_t opcode = 0;
+    std::function<void(Graph&)> mutation;
+    int args[2] = {0, 0};
+    int vertices = 0;
+    std::string name;  // Graph name, file path as the client gave it, or MST algorithm
+    std::uint64_t jobId = 0;
+    std::uint32_t timeoutMs = 0;
+    std::uint32_t treeLimit = 0;  // FOREST: how many trees to list
+    std::string error;  // Non-empty if the payload does not fit the opcode
+    std::shared_ptr<EdgeLoader::LoadResult> load;  // Filled in by a LOAD_FILE mutation
+    std::shared_ptr<GraphSnapshot::Result> snapshot;  // Filled in by LOAD_SNAPSHOT and SAVE_SNAPSHOT
+
+    bool isMutation() const { return static_cast<bool>(mutation); }
+    // Loads and saves run on the graph's shard like mutations but are answered once they ran
+    bool isFileCommand() const { return opcode == LOAD_FILE || opcode == LOAD_SNAPSHOT || opcode == SAVE_SNAPSHOT; }
+    bool isRegistry() const { return opcode == CREATE_NAMED || opcode == OPEN_GRAPH || opcode == DROP_GRAPH; }
+    bool isJob() const { return opcode >= SUBMIT_MST && opcode <= CANCEL_JOB; }
+    bool isSubmit() const { return opcode == SUBMIT_MST || opcode == SUBMIT_SHORTEST_PATH; }
+    bool needsGraph() const { return opcode != CLOSE && opcode != STATS && !isRegistry() && (!isJob() || isSubmit()); }
+};
+
+Command decode(const Frame& frame);
+
+// Answer a read-only command from a graph snapshot, or a finished file command
+void answerQuery(const Command& command, const Graph& graph, std::string& out);
+
+// Run CREATE_NAMED, OPEN_GRAPH or DROP_GRAPH, moving the session's current graph as needed
+void runRegistryCommand(GraphRegistry& graphs, GraphRegistry::Handle& current, const Command& command, std::string& out);
+
+// Run a job command; submissions use the session's current graph
+void runJobCommand(JobManager& jobs, const GraphRegistry::Handle& current, const Command& command, std::string& out);
+
+// Answer STATS with Metrics::report()
+void appendStats(std::string& out);
+
+// Histogram id "command.binary.<opcode name>" for per-command latency; unknown opcodes share one
+int opcodeMetric(std::uint8_t opcode);
+
+void appendOk(std::string& out, std::uint8_t opcode);
+void appendError(std::string& out, std::uint8_t opcode, const std::string& message);
+
+}  // namespace BinaryProtocol
+
+#endif  // BINARY_PROTOCOL_HPP
@@ -0,0 +1,56 @@
+#ifndef CANCEL_TOKEN_HPP
+#define CANCEL_TOKEN_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+// Cooperative cancellation for long computations.
+// The MST algorithms and path searches take an optional token and poll it at their
+// cancellation points; once it fires they stop early and return whatever partial answer
+// they have, which the caller must discard. A token fires when cancel() is called or, if it
+// has one, when its deadline passes.
+class CancelToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Hot loops poll every CHECK_INTERVAL iterations, so a check costs a clock read per interval
+    static const std::size_t CHECK_INTERVAL = 1024;
+
+    CancelToken() = default;
+    explicit CancelToken(Clock::time_point deadline) : deadline(deadline), hasDeadline(true) {}
+
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+    bool stopRequested() const {
+        if (cancelled.load(std::memory_order_relaxed) || expired.load(std::memory_order_relaxed)) return true;
+        if (hasDeadline && Clock::now() >= deadline) {
+            expired.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    bool wasCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    // Only known once a poll noticed the deadline
+    bool deadlinePassed() const { return expired.load(std::memory_order_relaxed); }
+
+    // Cancellation point for a loop on its iteration-th pass; tolerates a null token
+    static bool poll(const CancelToken* token, std::size_t iteration) {
+        return token != nullptr && iteration % CHECK_INTERVAL == 0 && token->stopRequested();
+    }
+
+    // Cancellation point for work coarse enough to check every time
+    static bool check(const CancelToken* token) { return token != nullptr && token->stopRequested(); }
+
+private:
+    Clock::time_point deadline;
+    bool hasDeadline = false;
+    std::atomic<bool> cancelled{false};
+    mutable std::atomic<bool> expired{false};
+};
+
+#endif  // CANCEL_TOKEN_HPP
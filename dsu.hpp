@@ -0,0 +1,95 @@
+#ifndef DSU_HPP
+#define DSU_HPP
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Disjoint-set union by rank with path compression, over vertices 0..n-1
+class DSU {
+    std::vector<int> parent, rank;
+
+public:
+    DSU(int n) : parent(n, -1), rank(n, 1) {}
+
+    // Iterative two-pass path compression, so deep trees cannot overflow the stack
+    int find(int i) {
+        int root = i;
+        while (parent[root] != -1)
+            root = parent[root];
+        while (parent[i] != -1) {
+            int next = parent[i];
+            parent[i] = root;
+            i = next;
+        }
+        return root;
+    }
+
+    void unite(int x, int y) {
+        int s1 = find(x);
+        int s2 = find(y);
+
+        if (s1 != s2) {
+            if (rank[s1] < rank[s2]) {
+                parent[s1] = s2;
+            } else if (rank[s1] > rank[s2]) {
+                parent[s2] = s1;
+            } else {
+                parent[s2] = s1;
+                rank[s1] += 1;
+            }
+        }
+    }
+};
+
+// Union-find that any number of threads may use at once without locks.
+// Roots are linked by a CAS on the root's parent slot, always the larger root under the
+// smaller, so no cycle can form and every set's root is its smallest vertex. find() halves
+// the path as it walks it, pointing each visited vertex at its grandparent, also by CAS; a
+// failed halving CAS just means another thread shortened the path first.
+class ConcurrentDSU {
+    std::unique_ptr<std::atomic<int>[]> parent;
+
+public:
+    explicit ConcurrentDSU(int n) : parent(new std::atomic<int>[n > 0 ? n : 1]) {
+        for (int i = 0; i < n; ++i) parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    int find(int i) {
+        while (true) {
+            int up = parent[i].load(std::memory_order_acquire);
+            if (up == i) return i;
+            int grand = parent[up].load(std::memory_order_acquire);
+            if (grand == up) return up;
+            parent[i].compare_exchange_weak(up, grand, std::memory_order_release, std::memory_order_relaxed);
+            i = grand;
+        }
+    }
+
+    // True if x and y were in different sets and this call merged them
+    bool unite(int x, int y) {
+        while (true) {
+            x = find(x);
+            y = find(y);
+            if (x == y) return false;
+            if (x < y) std::swap(x, y);
+            int expected = x;
+            // Fails only if x stopped being a root meanwhile; retry from the new roots
+            if (parent[x].compare_exchange_strong(expected, y, std::memory_order_acq_rel)) return true;
+        }
+    }
+
+    // Exact even while other threads unite: a root that is still a root after both finds
+    // proves the sets were different at that moment
+    bool sameSet(int x, int y) {
+        while (true) {
+            x = find(x);
+            y = find(y);
+            if (x == y) return true;
+            if (parent[x].load(std::memory_order_acquire) == x) return false;
+        }
+    }
+};
+
+#endif  // DSU_HPP
@@ -0,0 +1,190 @@
+#include "dynamic_mst.hpp"
+#include "graph.hpp"
+#include "kruskal.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+
+// After this many mutations without an MST query the forest is dropped and rebuilt lazily,
+// so bulk loads do not pay a tree walk per edge
+static const int MAX_UPDATES_BETWEEN_QUERIES = 256;
+
+DynamicMST::DynamicMST(int V) : V(V) {}
+
+void DynamicMST::invalidate() {
+    ++treeVersion;
+    valid = false;
+    treeEdges.clear();
+    treeAdj.clear();
+}
+
+// A full rebuild sorts every edge, so it forks onto the shared pool like the MST demo does;
+// the shard thread that asked helps, and idle workers take the rest
+void DynamicMST::rebuild(Graph& graph) {
+    KruskalMST kruskal(resolveThreadCount(0), false);
+    adopt(kruskal.computeMST(graph));
+}
+
+void DynamicMST::adopt(std::vector<std::tuple<int, int, int>> forest) {
+    treeEdges = std::move(forest);
+    treeAdj.assign(V, {});
+    for (const auto& edge : treeEdges) {
+        int weight, u, v;
+        std::tie(weight, u, v) = edge;
+        treeAdj[u].push_back({v, weight});
+        treeAdj[v].push_back({u, weight});
+    }
+    if (static_cast<int>(stamp.size()) != V) {
+        stamp.assign(V, 0);
+        sideStamp.assign(V, 0);
+        parent.assign(V, -1);
+        parentWeight.assign(V, 0);
+        epoch = 0;
+    }
+    ++treeVersion;
+    valid = true;
+    updatesSinceQuery = 0;
+}
+
+bool DynamicMST::chargeUpdate() {
+    if (!valid) return false;
+    if (++updatesSinceQuery > MAX_UPDATES_BETWEEN_QUERIES) {
+        invalidate();
+        return false;
+    }
+    return true;
+}
+
+unsigned DynamicMST::nextEpoch() {
+    if (++epoch == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        std::fill(sideStamp.begin(), sideStamp.end(), 0);
+        epoch = 1;
+    }
+    return epoch;
+}
+
+void DynamicMST::linkTree(int u, int v, int weight) {
+    ++treeVersion;
+    treeEdges.push_back({weight, u, v});
+    treeAdj[u].push_back({v, weight});
+    treeAdj[v].push_back({u, weight});
+}
+
+void DynamicMST::cutTree(int u, int v, int weight) {
+    ++treeVersion;
+    auto detach = [weight](std::vector<std::pair<int, int>>& adj, int to) {
+        for (std::size_t i = 0; i < adj.size(); ++i) {
+            if (adj[i].first == to && adj[i].second == weight) {
+                adj[i] = adj.back();
+                adj.pop_back();
+                return;
+            }
+        }
+    };
+    detach(treeAdj[u], v);
+    detach(treeAdj[v], u);
+
+    for (std::size_t i = 0; i < treeEdges.size(); ++i) {
+        int w, a, b;
+        std::tie(w, a, b) = treeEdges[i];
+        if (w == weight && ((a == u && b == v) || (a == v && b == u))) {
+            treeEdges[i] = treeEdges.back();
+            treeEdges.pop_back();
+            return;
+        }
+    }
+}
+
+// The new edge either joins two trees or closes a cycle; in the latter case it replaces
+// the heaviest edge on that cycle if it is lighter
+void DynamicMST::onEdgeAdded(const Graph&, int u, int v, int weight) {
+    if (!chargeUpdate() || u == v) return;
+
+    // BFS through the tree from u until v is reached, remembering parent edges
+    unsigned mark = nextEpoch();
+    std::vector<int> queue{u};
+    stamp[u] = mark;
+    bool found = false;
+    for (std::size_t i = 0; i < queue.size() && !found; ++i) {
+        int x = queue[i];
+        for (const auto& next : treeAdj[x]) {
+            int y = next.first;
+            if (stamp[y] == mark) continue;
+            stamp[y] = mark;
+            parent[y] = x;
+            parentWeight[y] = next.second;
+            if (y == v) {
+                found = true;
+                break;
+            }
+            queue.push_back(y);
+        }
+    }
+
+    if (!found) {
+        linkTree(u, v, weight);
+        return;
+    }
+
+    int heaviest = v;
+    for (int x = v; x != u; x = parent[x]) {
+        if (parentWeight[x] > parentWeight[heaviest]) heaviest = x;
+    }
+    if (weight < parentWeight[heaviest]) {
+        cutTree(heaviest, parent[heaviest], parentWeight[heaviest]);
+        linkTree(u, v, weight);
+    }
+}
+
+// Removing a tree edge splits one tree in two; the cheapest graph edge leaving the smaller
+// half is the replacement. Both halves are explored in lockstep so only the smaller one is
+// walked in full.
+void DynamicMST::onEdgeRemoved(const Graph& graph, int u, int v) {
+    if (!chargeUpdate() || u == v) return;
+
+    int treeWeight = 0;
+    bool isTreeEdge = false;
+    for (const auto& next : treeAdj[u]) {
+        if (next.first == v) {
+            treeWeight = next.second;
+            isTreeEdge = true;
+            break;
+        }
+    }
+    if (!isTreeEdge) return;  // Non-tree edges never affect the forest
+    cutTree(u, v, treeWeight);
+
+    unsigned mark = nextEpoch();
+    std::vector<int> sideU{u}, sideV{v};
+    stamp[u] = mark;
+    sideStamp[v] = mark;
+    std::size_t iu = 0, iv = 0;
+    auto expand = [this, mark](std::vector<int>& side, std::size_t& index, std::vector<unsigned>& marks) {
+        int x = side[index++];
+        for (const auto& next : treeAdj[x]) {
+            if (marks[next.first] == mark) continue;
+            marks[next.first] = mark;
+            side.push_back(next.first);
+        }
+    };
+    while (iu < sideU.size() && iv < sideV.size()) {
+        expand(sideU, iu, stamp);
+        if (iu < sideU.size()) expand(sideV, iv, sideStamp);
+    }
+    bool smallIsU = iu == sideU.size();
+    const std::vector<int>& small = smallIsU ? sideU : sideV;
+    const std::vector<unsigned>& inSmall = smallIsU ? stamp : sideStamp;
+
+    int bestFrom = -1, bestTo = -1, bestWeight = 0;
+    for (int x : small) {
+        graph.forEachNeighbor(x, [&](int y, int weight) {
+            if (inSmall[y] == mark) return;
+            if (bestFrom == -1 || weight < bestWeight) {
+                bestFrom = x;
+                bestTo = y;
+                bestWeight = weight;
+            }
+        });
+    }
+    if (bestFrom != -1) linkTree(bestFrom, bestTo, bestWeight);
+}
@@ -0,0 +1,57 @@
+#ifndef DYNAMIC_MST_HPP
+#define DYNAMIC_MST_HPP
+
+#include <vector>
+#include <tuple>
+#include <utility>
+
+class Graph;
+
+// Minimum spanning forest kept up to date across single edge insertions and deletions.
+// Inserting an edge swaps out the heaviest edge on the cycle it closes; deleting a tree
+// edge reconnects the two halves with the cheapest edge across the cut. Bulk changes
+// invalidate the forest and the next query rebuilds it with Kruskal.
+class DynamicMST {
+public:
+    explicit DynamicMST(int V = 0);
+
+    bool isValid() const { return valid; }
+    void invalidate();
+    void rebuild(Graph& graph);
+    // Take over a forest computed elsewhere, e.g. one restored from a snapshot
+    void adopt(std::vector<std::tuple<int, int, int>> forest);
+
+    // Called by Graph after the adjacency store has been updated
+    void onEdgeAdded(const Graph& graph, int u, int v, int weight);
+    void onEdgeRemoved(const Graph& graph, int u, int v);
+
+    // Start of a query: resets the budget of incremental updates
+    void markQueried() { updatesSinceQuery = 0; }
+
+    const std::vector<std::tuple<int, int, int>>& edges() const { return treeEdges; }
+
+    // Bumped whenever the forest changes, so derived indexes know when to rebuild
+    unsigned long long version() const { return treeVersion; }
+
+private:
+    int V;
+    bool valid = false;
+    int updatesSinceQuery = 0;
+    unsigned long long treeVersion = 0;
+    std::vector<std::tuple<int, int, int>> treeEdges;      // (weight, u, v)
+    std::vector<std::vector<std::pair<int, int>>> treeAdj;  // (neighbor, weight)
+
+    // BFS scratch, reused across updates; a vertex is marked when stamp[x] == epoch
+    std::vector<unsigned> stamp;
+    std::vector<unsigned> sideStamp;
+    std::vector<int> parent;
+    std::vector<int> parentWeight;
+    unsigned epoch = 0;
+
+    bool chargeUpdate();
+    void linkTree(int u, int v, int weight);
+    void cutTree(int u, int v, int weight);
+    unsigned nextEpoch();
+};
+
+#endif  // DYNAMIC_MST_HPP
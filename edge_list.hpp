@@ -0,0 +1,34 @@
+#ifndef EDGE_LIST_HPP
+#define EDGE_LIST_HPP
+
+#include "graph.hpp"
+#include <vector>
+#include <tuple>
+#include <cstddef>
+
+// Structure-of-arrays copy of a graph's edges: edge i is (u[i], v[i], weight[i])
+struct EdgeList {
+    std::vector<int> u;
+    std::vector<int> v;
+    std::vector<int> weight;
+
+    std::size_t size() const { return weight.size(); }
+
+    std::tuple<int, int, int> tuple(std::size_t i) const {
+        return std::make_tuple(weight[i], u[i], v[i]);
+    }
+
+    static EdgeList fromGraph(const Graph& graph) {
+        const auto& edges = graph.getEdges();
+        EdgeList list;
+        list.u.resize(edges.size());
+        list.v.resize(edges.size());
+        list.weight.resize(edges.size());
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            std::tie(list.weight[i], list.u[i], list.v[i]) = edges[i];
+        }
+        return list;
+    }
+};
+
+#endif  // EDGE_LIST_HPP
@@ -0,0 +1,372 @@
+#include "edge_loader.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+
+namespace EdgeLoader {
+
+namespace {
+
+// Bytes of text per parsing thread at the least (PARALLEL_GRAIN * 256 = 1 MiB)
+const std::size_t TEXT_BYTES_PER_ITEM = 256;
+
+struct ChunkResult {
+    std::vector<int> triples;
+    int maxVertex = -1;
+    std::size_t skipped = 0;
+};
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+// Parse the complete lines in [p, end)
+void parseText(const char* p, const char* end, ChunkResult& out) {
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (eol == nullptr) eol = end;
+        const char* cursor = skipBlanks(p, eol);
+        p = eol + 1;
+        if (cursor == eol || *cursor == '#' || *cursor == '%') continue;
+
+        int values[3];
+        bool ok = true;
+        for (int i = 0; i < 3 && ok; ++i) {
+            cursor = skipBlanks(cursor, eol);
+            auto parsed = std::from_chars(cursor, eol, values[i]);
+            ok = parsed.ec == std::errc();
+            cursor = parsed.ptr;
+        }
+        if (!ok || skipBlanks(cursor, eol) != eol || values[0] < 0 || values[1] < 0) {
+            ++out.skipped;
+            continue;
+        }
+        out.triples.insert(out.triples.end(), values, values + 3);
+        out.maxVertex = std::max(out.maxVertex, std::max(values[0], values[1]));
+    }
+}
+
+LoadResult parseTextFile(const char* data, std::size_t size, std::vector<int>& triples, unsigned numThreads) {
+    unsigned chunks = chunkCount(size / TEXT_BYTES_PER_ITEM, resolveThreadCount(numThreads));
+
+    // Chunk c covers [bounds[c], bounds[c + 1]); every inner bound sits just past a newline
+    std::vector<std::size_t> bounds(chunks + 1, size);
+    bounds[0] = 0;
+    for (unsigned c = 1; c < chunks; ++c) {
+        std::size_t at = std::max(bounds[c - 1], size / chunks * c);
+        const void* newline = std::memchr(data + at, '\n', size - at);
+        bounds[c] = newline == nullptr ? size : static_cast<std::size_t>(static_cast<const char*>(newline) - data) + 1;
+    }
+
+    std::vector<ChunkResult> parts(chunks);
+    parallelChunks(chunks, chunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+        for (std::size_t c = lo; c < hi; ++c) {
+            // Roughly 16 bytes per "u v w" line
+            parts[c].triples.reserve((bounds[c + 1] - bounds[c]) / 16 * 3);
+            parseText(data + bounds[c], data + bounds[c + 1], parts[c]);
+        }
+    });
+
+    LoadResult result;
+    std::vector<std::size_t> offsets(chunks + 1, 0);
+    int maxVertex = -1;
+    for (unsigned c = 0; c < chunks; ++c) {
+        offsets[c + 1] = offsets[c] + parts[c].triples.size();
+        maxVertex = std::max(maxVertex, parts[c].maxVertex);
+        result.skippedLines += parts[c].skipped;
+    }
+
+    // Merge the per-thread buffers with one parallel copy, freeing each as it goes
+    triples.resize(offsets[chunks]);
+    parallelChunks(chunks, chunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+        for (std::size_t c = lo; c < hi; ++c) {
+            std::copy(parts[c].triples.begin(), parts[c].triples.end(), triples.begin() + offsets[c]);
+            std::vector<int>().swap(parts[c].triples);
+        }
+    });
+
+    if (maxVertex == INT_MAX) {
+        result.error = "vertex id too large";
+        return result;
+    }
+    result.ok = true;
+    result.vertices = maxVertex + 1;
+    result.edges = triples.size() / 3;
+    return result;
+}
+
+std::uint32_t loadU32(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8 |
+           static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+}
+
+LoadResult parseBinaryFile(const char* data, std::size_t size, std::vector<int>& triples, unsigned numThreads) {
+    LoadResult result;
+    if (size < BINARY_HEADER_SIZE || std::memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+        result.error = "missing binary edge-list header";
+        return result;
+    }
+    if ((size - BINARY_HEADER_SIZE) % 12 != 0) {
+        result.error = "truncated binary edge list";
+        return result;
+    }
+    std::uint32_t headerVertices = loadU32(data + sizeof(BINARY_MAGIC));
+    const char* body = data + BINARY_HEADER_SIZE;
+    std::size_t count = (size - BINARY_HEADER_SIZE) / 12;
+
+    triples.resize(3 * count);
+    unsigned chunks = chunkCount(count, resolveThreadCount(numThreads));
+    std::vector<ChunkResult> parts(chunks);
+    parallelChunks(count, chunks, [&](unsigned chunk, std::size_t lo, std::size_t hi) {
+        int* out = triples.data() + 3 * lo;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        std::memcpy(out, body + 12 * lo, 12 * (hi - lo));
+#else
+        for (std::size_t i = 0; i < 3 * (hi - lo); ++i) out[i] = static_cast<int>(loadU32(body + 12 * lo + 4 * i));
+#endif
+        ChunkResult& part = parts[chunk];
+        for (std::size_t i = 0; i < hi - lo; ++i) {
+            int u = out[3 * i], v = out[3 * i + 1];
+            if (u < 0 || v < 0) ++part.skipped;  // Dropped by the graph
+            part.maxVertex = std::max(part.maxVertex, std::max(u, v));
+        }
+    });
+
+    int maxVertex = -1;
+    for (const auto& part : parts) {
+        maxVertex = std::max(maxVertex, part.maxVertex);
+        result.skippedLines += part.skipped;
+    }
+    if (headerVertices > static_cast<std::uint32_t>(INT_MAX) || (headerVertices == 0 && maxVertex == INT_MAX)) {
+        result.error = "vertex count too large";
+        return result;
+    }
+    result.ok = true;
+    result.vertices = headerVertices > 0 ? static_cast<int>(headerVertices) : maxVertex + 1;
+    result.edges = count - result.skippedLines;
+    return result;
+}
+
+}  // namespace
+
+LoadResult parseFile(const std::string& path, std::vector<int>& triples, Format format, unsigned numThreads) {
+    triples.clear();
+    MappedFile file;
+    if (!file.open(path)) {
+        LoadResult result;
+        result.error = std::string("cannot open file: ") + std::strerror(errno);
+        return result;
+    }
+    if (format == AUTO) {
+        bool magic = file.size() >= sizeof(BINARY_MAGIC) &&
+                     std::memcmp(file.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+        format = magic ? BINARY : TEXT;
+    }
+    if (format == BINARY) return parseBinaryFile(file.data(), file.size(), triples, numThreads);
+    return parseTextFile(file.data(), file.size(), triples, numThreads);
+}
+
+LoadResult loadGraph(const std::string& path, Graph& graph, int vertices, Format format, unsigned numThreads) {
+    std::vector<int> triples;
+    LoadResult result = parseFile(path, triples, format, numThreads);
+    if (!result.ok) return result;
+    if (vertices > 0) result.vertices = vertices;
+    if (result.vertices > Graph::vertexLimit()) {
+        result.ok = false;
+        result.error = std::to_string(result.vertices) + " vertices exceed the limit of " +
+                       std::to_string(Graph::vertexLimit());
+        return result;
+    }
+
+    graph = Graph(result.vertices);
+    graph.addEdges(triples.data(), triples.size() / 3);
+    return result;
+}
+
+std::function<void(Graph&)> loadInto(const std::string& path, std::shared_ptr<LoadResult> result) {
+    return [path, result](Graph& graph) {
+        Graph loaded(0);
+        *result = loadGraph(path, loaded);
+        if (result->ok) graph = std::move(loaded);
+    };
+}
+
+namespace {
+
+// read() until the buffer is full or the file ends; -1 on error
+ssize_t readFully(int fd, char* buffer, std::size_t size) {
+    std::size_t filled = 0;
+    while (filled < size) {
+        ssize_t n = read(fd, buffer + filled, size - filled);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) break;
+        filled += static_cast<std::size_t>(n);
+    }
+    return static_cast<ssize_t>(filled);
+}
+
+}  // namespace
+
+LoadResult streamFile(const std::string& path, std::size_t bufferBytes,
+                      const std::function<bool(const int* triples, std::size_t count)>& sink, Format format) {
+    LoadResult result;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        result.error = std::string("cannot open file: ") + std::strerror(errno);
+        return result;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Whole 12-byte records for the binary format, and room for at least one long text line
+    bufferBytes = std::max<std::size_t>(bufferBytes, 4096) / 12 * 12;
+    std::vector<char> buffer(bufferBytes);
+    ssize_t got = readFully(fd, buffer.data(), BINARY_HEADER_SIZE);
+    std::size_t carried = got > 0 ? static_cast<std::size_t>(got) : 0;
+    if (format == AUTO) {
+        bool magic = carried >= sizeof(BINARY_MAGIC) && std::memcmp(buffer.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+        format = magic ? BINARY : TEXT;
+    }
+    std::uint32_t headerVertices = 0;
+    if (format == BINARY) {
+        if (carried < BINARY_HEADER_SIZE || std::memcmp(buffer.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+            ::close(fd);
+            result.error = "missing binary edge-list header";
+            return result;
+        }
+        headerVertices = loadU32(buffer.data() + sizeof(BINARY_MAGIC));
+        carried = 0;
+    }
+
+    ChunkResult batch;
+    bool failed = got < 0, stopped = false;
+    while (!failed) {
+        got = readFully(fd, buffer.data() + carried, buffer.size() - carried);
+        if (got < 0) {
+            failed = true;
+            break;
+        }
+        std::size_t filled = carried + static_cast<std::size_t>(got);
+        bool atEnd = filled < buffer.size();
+        std::size_t used;
+        if (format == BINARY) {
+            used = filled / 12 * 12;
+            batch.triples.resize(used / 4);
+            const char* body = buffer.data();
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            std::memcpy(batch.triples.data(), body, used);
+#else
+            for (std::size_t i = 0; i < used / 4; ++i) batch.triples[i] = static_cast<int>(loadU32(body + 4 * i));
+#endif
+            // Compact away edges with negative ids, which a graph would drop
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < used / 12; ++i) {
+                int u = batch.triples[3 * i], v = batch.triples[3 * i + 1];
+                if (u < 0 || v < 0) {
+                    ++batch.skipped;
+                    continue;
+                }
+                batch.maxVertex = std::max(batch.maxVertex, std::max(u, v));
+                std::copy_n(&batch.triples[3 * i], 3, &batch.triples[3 * kept++]);
+            }
+            batch.triples.resize(3 * kept);
+            if (atEnd && used != filled) {
+                ::close(fd);
+                result.error = "truncated binary edge list";
+                return result;
+            }
+        } else {
+            // Parse up to the last newline and carry the partial line over
+            const char* data = buffer.data();
+            const char* last = filled > 0 ? static_cast<const char*>(memrchr(data, '\n', filled)) : nullptr;
+            used = atEnd ? filled : last == nullptr ? 0 : static_cast<std::size_t>(last - data) + 1;
+            if (used == 0 && !atEnd) {
+                // A line longer than the whole buffer cannot be an edge; drop it
+                if (buffer[0] != '#' && buffer[0] != '%') ++batch.skipped;
+                std::size_t dropped = filled;
+                while (true) {
+                    got = readFully(fd, buffer.data(), buffer.size());
+                    if (got <= 0) break;
+                    const void* newline = std::memchr(buffer.data(), '\n', static_cast<std::size_t>(got));
+                    if (newline != nullptr) {
+                        dropped = static_cast<std::size_t>(static_cast<const char*>(newline) - buffer.data()) + 1;
+                        filled = static_cast<std::size_t>(got);
+                        break;
+                    }
+                }
+                if (got <= 0) {
+                    failed = got < 0;
+                    break;
+                }
+                std::memmove(buffer.data(), buffer.data() + dropped, filled - dropped);
+                carried = filled - dropped;
+                continue;
+            }
+            batch.triples.clear();
+            parseText(data, data + used, batch);
+        }
+
+        result.edges += batch.triples.size() / 3;
+        if (!batch.triples.empty() && !sink(batch.triples.data(), batch.triples.size() / 3)) {
+            stopped = true;
+            break;
+        }
+        carried = filled - used;
+        std::memmove(buffer.data(), buffer.data() + used, carried);
+        if (atEnd) break;
+    }
+    if (failed) result.error = std::string("read failed: ") + std::strerror(errno);
+    ::close(fd);
+    if (failed) return result;
+    if (stopped) {
+        result.error = "stopped before the end of the file";
+        return result;
+    }
+
+    result.skippedLines = batch.skipped;
+    if (headerVertices > static_cast<std::uint32_t>(INT_MAX) || (headerVertices == 0 && batch.maxVertex == INT_MAX)) {
+        result.error = "vertex count too large";
+        return result;
+    }
+    result.ok = true;
+    result.vertices = headerVertices > 0 ? static_cast<int>(headerVertices) : batch.maxVertex + 1;
+    return result;
+}
+
+bool writeBinary(const std::string& path, const std::vector<int>& triples, int vertices) {
+    std::string out(BINARY_HEADER_SIZE, '\0');
+    std::memcpy(&out[0], BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    std::uint32_t count = static_cast<std::uint32_t>(std::max(vertices, 0));
+    for (int i = 0; i < 4; ++i) out[sizeof(BINARY_MAGIC) + i] = static_cast<char>(count >> (8 * i));
+    out.reserve(BINARY_HEADER_SIZE + 4 * triples.size());
+    for (int value : triples) {
+        std::uint32_t raw = static_cast<std::uint32_t>(value);
+        char bytes[4] = {static_cast<char>(raw), static_cast<char>(raw >> 8), static_cast<char>(raw >> 16),
+                         static_cast<char>(raw >> 24)};
+        out.append(bytes, 4);
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+std::string describe(const LoadResult& result, const std::string& path) {
+    if (!result.ok) return "Failed to load '" + path + "': " + result.error;
+    std::string text = "Loaded " + std::to_string(result.edges) + " edges over " + std::to_string(result.vertices) +
+                       " vertices from '" + path + "'";
+    if (result.skippedLines > 0) text += " (" + std::to_string(result.skippedLines) + " malformed entries skipped)";
+    return text;
+}
+
+}  // namespace EdgeLoader
@@ -0,0 +1,64 @@
+#ifndef EDGE_LOADER_HPP
+#define EDGE_LOADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+
+// Bulk loading of edge-list files.
+// The file is memory-mapped and split into one chunk per thread at line boundaries; every
+// thread parses its chunk with std::from_chars into its own triple buffer, and the buffers are
+// copied in parallel into one array that Graph::addEdges merges into the CSR in a single pass.
+// Two formats are understood:
+//   text   - one "u v weight" edge per line, separated by spaces or tabs; lines starting
+//            with '#' or '%' are comments
+//   binary - BINARY_MAGIC, u32 vertex count (0 = infer), u32 reserved, then packed
+//            little-endian i32 (u, v, weight) triples, the same layout as an ADD_EDGES frame
+namespace EdgeLoader {
+
+const char BINARY_MAGIC[8] = {'M', 'S', 'T', 'E', 'D', 'G', 'E', 'S'};
+const std::size_t BINARY_HEADER_SIZE = 16;
+
+enum Format { AUTO, TEXT, BINARY };  // AUTO picks BINARY when the file starts with the magic
+
+struct LoadResult {
+    bool ok = false;
+    std::string error;
+    int vertices = 0;             // Largest vertex id + 1 unless the caller or file fixed it
+    std::size_t edges = 0;        // Triples parsed
+    std::size_t skippedLines = 0; // Malformed text lines and edges with negative ids
+};
+
+// Parse the file into packed (u, v, weight) triples
+LoadResult parseFile(const std::string& path, std::vector<int>& triples, Format format = AUTO,
+                     unsigned numThreads = 0);
+
+// Replace graph with the file's contents. vertices > 0 fixes the vertex count (edges outside
+// it are dropped by the graph); otherwise it is inferred from the file.
+LoadResult loadGraph(const std::string& path, Graph& graph, int vertices = 0, Format format = AUTO,
+                     unsigned numThreads = 0);
+
+// Mutation for GraphRegistry::update that replaces the graph with the file's contents and
+// reports into result; a failed load leaves the graph as it was
+std::function<void(Graph&)> loadInto(const std::string& path, std::shared_ptr<LoadResult> result);
+
+// Read the file front to back through a buffer of bufferBytes and hand its edges to sink in
+// batches of packed triples, without mapping or holding the whole file. Edges with negative
+// ids are skipped. Memory use is bounded by the buffer whatever the file size. A sink that
+// returns false stops the read, and the result is then not ok.
+LoadResult streamFile(const std::string& path, std::size_t bufferBytes,
+                      const std::function<bool(const int* triples, std::size_t count)>& sink, Format format = AUTO);
+
+// Write triples in the binary format, so text inputs can be converted once
+bool writeBinary(const std::string& path, const std::vector<int>& triples, int vertices);
+
+// One-line summary for logs and client replies
+std::string describe(const LoadResult& result, const std::string& path);
+
+}  // namespace EdgeLoader
+
+#endif  // EDGE_LOADER_HPP
@@ -0,0 +1,322 @@
+#include "external_kruskal.hpp"
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "dsu.hpp"
+
+namespace {
+
+// Input read buffer: a slice of the budget, large enough for long sequential reads
+const std::size_t MAX_READ_BUFFER = std::size_t(16) << 20;
+
+struct RunEdge {
+    int weight, u, v;
+};
+
+bool lighter(const RunEdge& a, const RunEdge& b) { return a.weight < b.weight; }
+
+// A stretch of a spill file holding count edges sorted by weight
+struct Run {
+    off_t offset;
+    std::size_t count;
+};
+
+// Temporary file for sorted runs, unlinked as soon as it is created so it disappears with
+// its descriptor however the process ends
+class SpillFile {
+public:
+    SpillFile() = default;
+    ~SpillFile() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    std::vector<Run> runs;
+
+    bool open(const std::string& dir, std::string& error) {
+        if (fd >= 0) return true;
+        std::string pattern = dir + "/mst-runs-XXXXXX";
+        fd = mkstemp(&pattern[0]);
+        if (fd < 0) {
+            error = "cannot create temporary file in " + dir + ": " + std::strerror(errno);
+            return false;
+        }
+        ::unlink(pattern.c_str());
+        return true;
+    }
+
+    // Start a run at the end of the file; append() then extends it
+    void beginRun() { runs.push_back({size, 0}); }
+
+    bool append(const RunEdge* edges, std::size_t count, std::string& error) {
+        const char* data = reinterpret_cast<const char*>(edges);
+        std::size_t bytes = count * sizeof(RunEdge);
+        while (bytes > 0) {
+            ssize_t n = ::pwrite(fd, data, bytes, size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                error = std::string("cannot write temporary file: ") + std::strerror(errno);
+                return false;
+            }
+            data += n;
+            bytes -= static_cast<std::size_t>(n);
+            size += n;
+        }
+        runs.back().count += count;
+        return true;
+    }
+
+    bool read(off_t offset, RunEdge* edges, std::size_t count, std::string& error) const {
+        char* data = reinterpret_cast<char*>(edges);
+        std::size_t bytes = count * sizeof(RunEdge);
+        while (bytes > 0) {
+            ssize_t n = ::pread(fd, data, bytes, offset);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                error = std::string("cannot read temporary file: ") + (n < 0 ? std::strerror(errno) : "truncated");
+                return false;
+            }
+            data += n;
+            bytes -= static_cast<std::size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+
+    // Drop every run and give the disk space back
+    void clear() {
+        runs.clear();
+        size = 0;
+        if (fd >= 0) {
+            int rc = ::ftruncate(fd, 0);  // Failing only costs disk space: new runs overwrite the file
+            (void)rc;
+        }
+    }
+
+private:
+    int fd = -1;
+    off_t size = 0;
+};
+
+// Yields the edges of a group of runs in weight order: a min-heap holds the next edge of
+// every run, and each run is read ahead through its own buffer of bufferEdges
+class RunMerger {
+public:
+    RunMerger(const SpillFile& file, const Run* runs, std::size_t count, std::size_t bufferEdges)
+        : file(file), bufferEdges(std::max<std::size_t>(bufferEdges, 1)) {
+        cursors.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            cursors[i].offset = runs[i].offset;
+            cursors[i].remaining = runs[i].count;
+            RunEdge edge;
+            if (advance(cursors[i], edge)) heap.push_back({edge, i});
+        }
+        std::make_heap(heap.begin(), heap.end(), heavier);
+    }
+
+    // False once every run is exhausted or a read failed (error is then set)
+    bool next(RunEdge& edge) {
+        if (heap.empty() || !error.empty()) return false;
+        std::pop_heap(heap.begin(), heap.end(), heavier);
+        Entry& top = heap.back();
+        edge = top.edge;
+        if (advance(cursors[top.cursor], top.edge)) {
+            std::push_heap(heap.begin(), heap.end(), heavier);
+        } else {
+            heap.pop_back();
+        }
+        return true;
+    }
+
+    std::string error;
+
+private:
+    struct Cursor {
+        off_t offset = 0;           // Next edge still on disk
+        std::size_t remaining = 0;  // Edges of the run still on disk
+        std::vector<RunEdge> buffer;
+        std::size_t pos = 0;
+    };
+
+    struct Entry {
+        RunEdge edge;
+        std::size_t cursor;
+    };
+
+    static bool heavier(const Entry& a, const Entry& b) { return a.edge.weight > b.edge.weight; }
+
+    const SpillFile& file;
+    std::size_t bufferEdges;
+    std::vector<Cursor> cursors;
+    std::vector<Entry> heap;
+
+    bool advance(Cursor& cursor, RunEdge& edge) {
+        if (cursor.pos == cursor.buffer.size()) {
+            if (cursor.remaining == 0) {
+                std::vector<RunEdge>().swap(cursor.buffer);
+                return false;
+            }
+            std::size_t count = std::min(cursor.remaining, bufferEdges);
+            cursor.buffer.resize(count);
+            if (!file.read(cursor.offset, cursor.buffer.data(), count, error)) return false;
+            cursor.offset += static_cast<off_t>(count * sizeof(RunEdge));
+            cursor.remaining -= count;
+            cursor.pos = 0;
+        }
+        edge = cursor.buffer[cursor.pos++];
+        return true;
+    }
+};
+
+std::string defaultTempDir() {
+    const char* dir = std::getenv("TMPDIR");
+    return dir != nullptr && *dir != '\0' ? dir : "/tmp";
+}
+
+}  // namespace
+
+ExternalKruskalMST::ExternalKruskalMST(std::size_t memoryBudget, const std::string& tempDir, bool verbose,
+                                       const CancelToken* cancel)
+    : memoryBudget(std::max(memoryBudget > 0 ? memoryBudget : DEFAULT_MEMORY_BUDGET, MIN_MEMORY_BUDGET)),
+      tempDir(tempDir.empty() ? defaultTempDir() : tempDir),
+      verbose(verbose),
+      cancel(cancel) {}
+
+std::vector<std::tuple<int, int, int>> ExternalKruskalMST::computeMST(const std::string& path,
+                                                                      EdgeLoader::LoadResult& load) {
+    runs = passes = 0;
+    const std::size_t readBytes = std::min(memoryBudget / 16, MAX_READ_BUFFER);
+    // The read buffer and its parsed batch, which holds up to twice its size for short lines
+    const std::size_t budgetEdges = (memoryBudget - 3 * readBytes) / sizeof(RunEdge);
+    std::string error;
+    bool cancelled = false;
+
+    // Phase 1: cut the input into sorted runs of up to budgetEdges edges
+    SpillFile files[2];
+    std::vector<RunEdge> run;
+    run.reserve(budgetEdges);
+    auto spill = [&]() {
+        std::sort(run.begin(), run.end(), lighter);
+        if (!files[0].open(tempDir, error)) return false;
+        files[0].beginRun();
+        if (!files[0].append(run.data(), run.size(), error)) return false;
+        run.clear();
+        return true;
+    };
+    load = EdgeLoader::streamFile(path, readBytes, [&](const int* triples, std::size_t count) {
+        if (CancelToken::check(cancel)) {
+            cancelled = true;
+            return false;
+        }
+        for (std::size_t i = 0; i < count; ++i, triples += 3) {
+            if (run.size() == budgetEdges && !spill()) return false;
+            run.push_back({triples[2], triples[0], triples[1]});
+        }
+        return true;
+    });
+    if (!error.empty() || cancelled) {
+        load.ok = false;
+        load.error = cancelled ? "cancelled" : error;
+    }
+    if (!load.ok) return {};
+
+    // Phase 2: Kruskal over the edges in weight order
+    const int V = load.vertices;
+    const std::size_t target = V > 0 ? static_cast<std::size_t>(V - 1) : 0;
+    std::vector<std::tuple<int, int, int>> mstEdges;
+    long long totalWeight = 0;
+    std::size_t scanned = 0;
+    auto accept = [&](const RunEdge& edge, DSU& dsu) {
+        if (mstEdges.size() == target || CancelToken::poll(cancel, ++scanned)) return false;
+        if (edge.u >= V || edge.v >= V) return true;  // Outside the vertex count the file declares
+        if (dsu.find(edge.u) != dsu.find(edge.v)) {
+            dsu.unite(edge.u, edge.v);
+            mstEdges.emplace_back(edge.weight, edge.u, edge.v);
+            totalWeight += edge.weight;
+            if (verbose)
+                std::cout << "External Kruskal: Edge: " << edge.u << " -- " << edge.v << " (weight: " << edge.weight
+                          << ")\n";
+        }
+        return true;
+    };
+    if (verbose) std::cout << "External Kruskal's MST selected edges:\n";
+
+    if (files[0].runs.empty()) {
+        // Everything fit in one run: no disk involved
+        std::sort(run.begin(), run.end(), lighter);
+        DSU dsu(V);
+        for (const RunEdge& edge : run) {
+            if (!accept(edge, dsu)) break;
+        }
+    } else {
+        if (!run.empty() && !spill()) {
+            load.ok = false;
+            load.error = error;
+            return {};
+        }
+        std::vector<RunEdge>().swap(run);  // The merge buffers take the budget from here on
+        runs = files[0].runs.size();
+
+        // One read buffer per merged run plus one write buffer, none below MIN_MERGE_READ
+        const std::size_t fanIn = std::max<std::size_t>(memoryBudget / MIN_MERGE_READ - 1, 2);
+        int current = 0;
+        while (files[current].runs.size() > fanIn) {
+            SpillFile& in = files[current];
+            SpillFile& out = files[1 - current];
+            const std::size_t bufferEdges = budgetEdges / (fanIn + 1);
+            std::vector<RunEdge> pending;
+            pending.reserve(bufferEdges);
+            if (!out.open(tempDir, error)) break;
+            for (std::size_t first = 0; first < in.runs.size() && error.empty(); first += fanIn) {
+                std::size_t count = std::min(fanIn, in.runs.size() - first);
+                RunMerger merger(in, &in.runs[first], count, bufferEdges);
+                out.beginRun();
+                RunEdge edge;
+                while (merger.next(edge)) {
+                    pending.push_back(edge);
+                    if (pending.size() == bufferEdges) {
+                        if (!out.append(pending.data(), pending.size(), error)) break;
+                        pending.clear();
+                    }
+                }
+                if (error.empty()) error = merger.error;
+                if (error.empty() && !out.append(pending.data(), pending.size(), error)) break;
+                pending.clear();
+                if (CancelToken::check(cancel)) error = "cancelled";
+            }
+            in.clear();
+            current = 1 - current;
+            ++passes;
+            if (!error.empty()) break;
+        }
+        if (!error.empty()) {
+            load.ok = false;
+            load.error = error;
+            return {};
+        }
+
+        const SpillFile& in = files[current];
+        RunMerger merger(in, in.runs.data(), in.runs.size(), budgetEdges / in.runs.size());
+        ++passes;
+        DSU dsu(V);
+        RunEdge edge;
+        while (merger.next(edge)) {
+            if (!accept(edge, dsu)) break;
+        }
+        if (!merger.error.empty()) {
+            load.ok = false;
+            load.error = merger.error;
+            return {};
+        }
+    }
+
+    if (verbose) std::cout << "External Kruskal's Total Weight: " << totalWeight << std::endl;
+    return mstEdges;
+}
@@ -0,0 +1,48 @@
+#ifndef EXTERNAL_KRUSKAL_HPP
+#define EXTERNAL_KRUSKAL_HPP
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "cancel_token.hpp"
+#include "edge_loader.hpp"
+
+// Out-of-core Kruskal for edge files larger than memory.
+// The file is streamed once through a bounded buffer into a run buffer; every time it fills,
+// the run is sorted by weight and spilled to an unlinked temporary file. The sorted runs are
+// then k-way merged with a min-heap, each run read through its own large buffer so the disk
+// sees long sequential reads; when there are more runs than buffers of MIN_MERGE_READ fit in
+// the budget, groups of runs are first merged into longer ones. The final merge feeds edges
+// in weight order to a DSU, so besides the budget only O(V) memory is used: the DSU and the
+// tree itself. An edge set that fits in one run never touches the disk.
+class ExternalKruskalMST {
+public:
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET = std::size_t(256) << 20;
+    static constexpr std::size_t MIN_MEMORY_BUDGET = std::size_t(4) << 20;
+    static constexpr std::size_t MIN_MERGE_READ = std::size_t(1) << 20;  // Per-run read buffer floor
+
+    // memoryBudget bounds the edge buffers (0 = DEFAULT_MEMORY_BUDGET); runs are spilled into
+    // tempDir, by default $TMPDIR or /tmp
+    explicit ExternalKruskalMST(std::size_t memoryBudget = 0, const std::string& tempDir = "", bool verbose = true,
+                                const CancelToken* cancel = nullptr);
+
+    // The minimum spanning tree of the edge-list file at path, in either EdgeLoader format.
+    // load describes the file as it was read; on a read or temporary-file error it is not ok
+    // and the tree is empty.
+    std::vector<std::tuple<int, int, int>> computeMST(const std::string& path, EdgeLoader::LoadResult& load);
+
+    // Sorted runs written and merge passes made by the last computeMST, final merge included
+    std::size_t runCount() const { return runs; }
+    std::size_t mergePasses() const { return passes; }
+
+private:
+    std::size_t memoryBudget;
+    std::string tempDir;
+    bool verbose;
+    const CancelToken* cancel;  // Polled between input batches and while merging
+    std::size_t runs = 0;
+    std::size_t passes = 0;
+};
+
+#endif  // EXTERNAL_KRUSKAL_HPP
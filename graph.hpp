@@ -3,31 +3,128 @@
 
 #include <vector>
 #include <tuple>
+#include <utility>
+#include <cstddef>
+#include <unordered_map>
+#include "dynamic_mst.hpp"
+#include "tree_path_index.hpp"
+#include "mst_stats.hpp"
+#include "lazy_value.hpp"
 
 class Graph {
 public:
     int V;
-    std::vector<std::tuple<int, int, int>> mstEdges;  // To store MST edges
-    std::vector<std::vector<int>> adjMatrix;  // Adjacency matrix
+    std::vector<std::tuple<int, int, int>> mstEdges;  // Edge list as (weight, u, v)
+
+    // Graphs hold at most vertexLimit() vertices. The constructor throws std::length_error
+    // beyond it; counts that come from clients or files are checked with isValidVertexCount
+    // first, so a request for a huge graph is refused instead of exhausting memory.
+    static constexpr int DEFAULT_VERTEX_LIMIT = 1 << 24;
+    static int vertexLimit();
+    static void setVertexLimit(int limit);
+    static bool isValidVertexCount(int V) { return V > 0 && V <= vertexLimit(); }
 
     Graph(int V);
 
     void addEdge(int u, int v, int weight);
     void removeEdge(int u, int v);
-    std::vector<std::tuple<int, int, int>> getEdges();
-    void addMSTEdge(int u, int v, int weight);
+    // Add `count` packed (u, v, weight) triples at once; the MST is rebuilt on its next query
+    void addEdges(const int* triples, std::size_t count);
+    const std::vector<std::tuple<int, int, int>>& getEdges() const;
+
+    // Minimum spanning forest maintained across addEdge/removeEdge; O(1) while up to date
+    const std::vector<std::tuple<int, int, int>>& getMST();
+
+    // Unique path between two vertices in the MST, answered by an LCA index in O(log V)
+    TreePath getTreePath(int start, int end);
+
+    // Every whole-tree statistic of the MST, computed in one O(V) pass and cached with it
+    const MSTStats& getMSTStats();
+
+    // Compact the graph and build the MST, its path index and its statistics up front, so
+    // the const queries below are pure reads
+    void freeze();
+
+    // Cheap step before a mutated copy is published, in place of freeze: a maintained forest
+    // gets a fresh update budget, and one that readers of the version this copy came from
+    // had to compute is adopted. Everything else waits for the first query.
+    void settle();
+
+    // Safe to call from any number of reader threads. What the graph lacks (the forest while
+    // the maintained one is invalid, the path index, the statistics) is built by the first
+    // reader that needs it, once per MST version, and shared with the others.
+    const std::vector<std::tuple<int, int, int>>& getMST() const;
+    TreePath getTreePath(int start, int end) const;
+    MSTStats getMSTStats() const;
+
+    // Adjacency access, proportional to the degree of u
+    bool isValidVertex(int u) const { return u >= 0 && u < V; }
+    int degree(int u) const;
+    template <typename Fn>
+    void forEachNeighbor(int u, Fn&& fn) const;  // fn(neighbor, weight)
+
+    // Fold the mutable overlay back into the CSR arrays
+    void compact();
+
+    // Bounds over every weight ever added, set by the first edge; 0 for a graph that never
+    // had one. They only widen: removing an edge does not recompute them, so they may be
+    // looser than the current edges' weights.
+    int getMaxEdgeWeight() const { return maxEdgeWeight; }
+    int getMinEdgeWeight() const { return minEdgeWeight; }
 
     // Statistics functions
-    int getTotalWeight();
-    int getLongestDistance();
+    long long getTotalWeight();
+    long long getLongestDistance();
     double getAverageDistance();
-    int getShortestDistance();
+    long long getShortestDistance();
 
     // Path-based functions
-    int getShortestPath(int start, int end);
-    int getLongestPath(int start, int end);
+    int getShortestPath(int start, int end);            // Early-exit bucket/radix-heap Dijkstra
+    int getShortestPathBidirectional(int start, int end);
 
     void printMST();
+
+private:
+    friend class GraphSnapshot;  // Saves and restores the arrays below wholesale
+
+    // CSR base: the neighbors of u live in csrNeighbors[csrOffsets[u] .. csrOffsets[u + 1]).
+    // Removed edges are left in place as tombstones (neighbor == -1) until the next compaction.
+    std::vector<std::size_t> csrOffsets;
+    std::vector<int> csrNeighbors;
+    std::vector<int> csrWeights;
+    std::size_t tombstones = 0;
+    int maxEdgeWeight = 0;
+    int minEdgeWeight = 0;
+    bool weighted = false;  // An edge was ever added, so the bounds above are real
+
+    // Edges added since the last compaction, keyed by vertex as (neighbor, weight)
+    std::unordered_map<int, std::vector<std::pair<int, int>>> overlay;
+    std::size_t overlayEntries = 0;
+
+    DynamicMST mst;
+    // Forest the const getMST computed while mst was invalid, keyed by mst.version()
+    LazyValue<std::vector<std::tuple<int, int, int>>> lazyForest;
+    // Built from the forest by the first query that needs them, keyed by mst.version()
+    LazyValue<TreePathIndex> pathIndex;
+    LazyValue<MSTStats> stats;
+
+    void noteWeight(int weight);
+    void appendOverlay(int u, int v, int weight);
+    void compactIfNeeded();
+    void rebuildCSR(std::size_t firstNew);
 };
 
+template <typename Fn>
+void Graph::forEachNeighbor(int u, Fn&& fn) const {
+    for (std::size_t i = csrOffsets[u]; i < csrOffsets[u + 1]; ++i) {
+        if (csrNeighbors[i] >= 0) fn(csrNeighbors[i], csrWeights[i]);
+    }
+    if (overlay.empty()) return;
+    auto it = overlay.find(u);
+    if (it == overlay.end()) return;
+    for (const auto& entry : it->second) {
+        fn(entry.first, entry.second);
+    }
+}
+
 #endif  // GRAPH_HPP
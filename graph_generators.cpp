@@ -0,0 +1,162 @@
+#include "graph_generators.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace GraphGenerators {
+
+namespace {
+
+// splitmix64: tiny, fast and fully specified, unlike the std:: distributions
+struct Random {
+    std::uint64_t state;
+
+    explicit Random(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, n) by multiply-shift
+    std::uint64_t below(std::uint64_t n) {
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+
+    // Uniform in [0, 1)
+    double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    int weight() { return 1 + static_cast<int>(below(MAX_WEIGHT)); }
+};
+
+void addEdge(GeneratedGraph& graph, int u, int v, int weight) {
+    graph.triples.push_back(u);
+    graph.triples.push_back(v);
+    graph.triples.push_back(weight);
+}
+
+// Random recursive tree over a shuffled vertex order: vertex order[i] hangs off an earlier one
+void addSpanningTree(GeneratedGraph& graph, Random& random) {
+    std::vector<int> order(graph.vertices);
+    for (int i = 0; i < graph.vertices; ++i) order[i] = i;
+    for (int i = graph.vertices - 1; i > 0; --i) std::swap(order[i], order[random.below(i + 1)]);
+    for (int i = 1; i < graph.vertices; ++i) addEdge(graph, order[i], order[random.below(i)], random.weight());
+}
+
+// Uniform random edges between distinct vertices until the graph has `edges` of them
+void addRandomEdges(GeneratedGraph& graph, std::size_t edges, Random& random) {
+    while (graph.edgeCount() < edges) {
+        int u = static_cast<int>(random.below(graph.vertices));
+        int v = static_cast<int>(random.below(graph.vertices));
+        if (u != v) addEdge(graph, u, v, random.weight());
+    }
+}
+
+}  // namespace
+
+GeneratedGraph erdosRenyi(std::size_t edges, std::uint64_t seed) {
+    Random random(seed);
+    GeneratedGraph graph;
+    graph.vertices = static_cast<int>(std::max<std::size_t>(2, edges / 4));
+    graph.triples.reserve(3 * std::max<std::size_t>(edges, graph.vertices - 1));
+    addSpanningTree(graph, random);
+    addRandomEdges(graph, edges, random);
+    return graph;
+}
+
+GeneratedGraph grid(std::size_t edges, std::uint64_t seed) {
+    Random random(seed);
+    // A rows x cols grid has about 2 * rows * cols edges; 1 in 64 edges is a shortcut
+    std::size_t cells = std::max<std::size_t>(4, edges / 2 - edges / 128);
+    int cols = std::max(2, static_cast<int>(std::sqrt(static_cast<double>(cells))));
+    int rows = std::max(2, static_cast<int>(cells / cols));
+    GeneratedGraph graph;
+    graph.vertices = rows * cols;
+    graph.triples.reserve(3 * std::max<std::size_t>(edges, 2 * graph.vertices));
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            int u = r * cols + c;
+            if (c + 1 < cols) addEdge(graph, u, u + 1, random.weight());
+            if (r + 1 < rows) addEdge(graph, u, u + cols, random.weight());
+        }
+    }
+    addRandomEdges(graph, edges, random);
+    return graph;
+}
+
+GeneratedGraph rmat(std::size_t edges, std::uint64_t seed) {
+    Random random(seed);
+    int scale = 4;
+    while (scale < 30 && (std::size_t(1) << scale) * 16 < edges) ++scale;
+    GeneratedGraph graph;
+    graph.vertices = 1 << scale;
+    graph.triples.reserve(3 * std::max<std::size_t>(edges, graph.vertices - 1));
+    addSpanningTree(graph, random);
+
+    const double a = 0.57, b = 0.19, c = 0.19;
+    while (graph.edgeCount() < edges) {
+        int u = 0, v = 0;
+        for (int bit = scale - 1; bit >= 0; --bit) {
+            double p = random.unit();
+            if (p < a) continue;
+            if (p < a + b) {
+                v |= 1 << bit;
+            } else if (p < a + b + c) {
+                u |= 1 << bit;
+            } else {
+                u |= 1 << bit;
+                v |= 1 << bit;
+            }
+        }
+        if (u != v) addEdge(graph, u, v, random.weight());
+    }
+    return graph;
+}
+
+GeneratedGraph geometric(std::size_t edges, std::uint64_t seed) {
+    Random random(seed);
+    // Smallest V with V (V - 1) / 2 >= edges
+    std::size_t V = static_cast<std::size_t>(std::ceil((1.0 + std::sqrt(1.0 + 8.0 * edges)) / 2.0));
+    while (V > 2 && (V - 1) * (V - 2) / 2 >= edges) --V;
+    V = std::max<std::size_t>(V, 2);
+
+    std::vector<double> x(V), y(V);
+    for (std::size_t i = 0; i < V; ++i) {
+        x[i] = random.unit();
+        y[i] = random.unit();
+    }
+    GeneratedGraph graph;
+    graph.vertices = static_cast<int>(V);
+    graph.triples.reserve(3 * V * (V - 1) / 2);
+    const double scale = (MAX_WEIGHT - 1) / std::sqrt(2.0);
+    for (std::size_t u = 0; u < V; ++u) {
+        for (std::size_t v = u + 1; v < V; ++v) {
+            double distance = std::hypot(x[u] - x[v], y[u] - y[v]);
+            addEdge(graph, static_cast<int>(u), static_cast<int>(v), 1 + static_cast<int>(distance * scale));
+        }
+    }
+    return graph;
+}
+
+bool generate(const std::string& name, std::size_t edges, std::uint64_t seed, GeneratedGraph& out) {
+    if (name == "er") {
+        out = erdosRenyi(edges, seed);
+    } else if (name == "grid") {
+        out = grid(edges, seed);
+    } else if (name == "rmat") {
+        out = rmat(edges, seed);
+    } else if (name == "geometric") {
+        out = geometric(edges, seed);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const std::vector<std::string>& names() {
+    static const std::vector<std::string> all = {"er", "grid", "rmat", "geometric"};
+    return all;
+}
+
+}  // namespace GraphGenerators
@@ -0,0 +1,47 @@
+#ifndef GRAPH_GENERATORS_HPP
+#define GRAPH_GENERATORS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Deterministic synthetic graphs for benchmarking. Every generator is driven by its own
+// splitmix64 stream, so a (generator, edge count, seed) triple produces the same graph on
+// every platform and standard library. Graphs come out as packed (u, v, weight) triples,
+// ready for Graph::addEdges or EdgeLoader::writeBinary, and are connected so that every MST
+// algorithm spans the same vertex set.
+namespace GraphGenerators {
+
+struct GeneratedGraph {
+    int vertices = 0;
+    std::vector<int> triples;
+
+    std::size_t edgeCount() const { return triples.size() / 3; }
+};
+
+// Uniform integer weights are drawn from [1, MAX_WEIGHT]
+const int MAX_WEIGHT = 1000000;
+
+// G(n, m): a random spanning tree plus uniformly random extra edges, average degree 8
+GeneratedGraph erdosRenyi(std::size_t edges, std::uint64_t seed);
+
+// Road-like: a 4-neighbour grid with random weights and a sprinkling of long shortcuts
+GeneratedGraph grid(std::size_t edges, std::uint64_t seed);
+
+// R-MAT power-law graph (a, b, c) = (0.57, 0.19, 0.19) with edge factor 16 over a random
+// spanning tree that keeps the many low-degree vertices attached
+GeneratedGraph rmat(std::size_t edges, std::uint64_t seed);
+
+// Complete graph over random points in the unit square, weighted by scaled Euclidean distance
+GeneratedGraph geometric(std::size_t edges, std::uint64_t seed);
+
+// Dispatch by name ("er", "grid", "rmat", "geometric"); false for an unknown name
+bool generate(const std::string& name, std::size_t edges, std::uint64_t seed, GeneratedGraph& out);
+
+// Names accepted by generate, in a stable order
+const std::vector<std::string>& names();
+
+}  // namespace GraphGenerators
+
+#endif  // GRAPH_GENERATORS_HPP
@@ -0,0 +1,182 @@
+#include "graph_registry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include "metrics.hpp"
+#include "parallel.hpp"
+
+const char* const GraphRegistry::DEFAULT_GRAPH = "default";
+
+namespace {
+
+// Where a shard's time goes for each batch: copying the published version, running the
+// mutations, and publishing the copy (which also frees versions no reader holds any more)
+const int BATCH_SIZE = Metrics::histogram("registry.batch_size", Metrics::COUNT);
+const int COPY_TIME = Metrics::histogram("registry.copy");
+const int APPLY_TIME = Metrics::histogram("registry.apply");
+const int PUBLISH_TIME = Metrics::histogram("registry.publish");
+
+}  // namespace
+
+GraphRegistry::GraphRegistry(unsigned numShards) {
+    unsigned count = resolveThreadCount(numShards);
+    shards.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        shards.emplace_back(new Shard());
+        shards.back()->worker.instrument("registry.shard" + std::to_string(i));
+    }
+    graphsGauge = Metrics::gauge("registry.graphs", [this]() {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        return static_cast<long long>(graphs.size());
+    });
+    create(DEFAULT_GRAPH, 0);
+}
+
+GraphRegistry::~GraphRegistry() {
+    Metrics::removeGauge(graphsGauge);
+}
+
+bool GraphRegistry::isValidName(const std::string& name) {
+    if (name.empty() || name.size() > MAX_NAME_LENGTH) return false;
+    for (char c : name) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '_' || c == '.' || c == '-';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+GraphRegistry::Handle GraphRegistry::create(const std::string& name, int V) {
+    if (!isValidName(name) || V < 0 || V > Graph::vertexLimit()) return nullptr;
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    if (graphs.count(name)) return nullptr;
+
+    // Pin to the least loaded shard; ties go to the lowest index
+    unsigned shard = 0;
+    for (unsigned i = 1; i < shards.size(); ++i) {
+        if (shards[i]->graphs < shards[shard]->graphs) shard = i;
+    }
+    Handle entry = std::make_shared<GraphEntry>(name, shard);
+    if (V > 0) entry->store.reset(Graph(V));  // Not yet visible to anyone, so no shard hop
+    ++shards[shard]->graphs;
+    graphs.emplace(name, entry);
+    return entry;
+}
+
+GraphRegistry::Handle GraphRegistry::open(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto it = graphs.find(name);
+    return it == graphs.end() ? nullptr : it->second;
+}
+
+bool GraphRegistry::drop(const std::string& name) {
+    if (name == DEFAULT_GRAPH) return false;
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    auto it = graphs.find(name);
+    if (it == graphs.end()) return false;
+    it->second->dropped.store(true, std::memory_order_release);
+    --shards[it->second->shard]->graphs;
+    graphs.erase(it);
+    return true;
+}
+
+std::vector<std::string> GraphRegistry::names() const {
+    std::vector<std::string> result;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        result.reserve(graphs.size());
+        for (const auto& entry : graphs) {
+            result.push_back(entry.first);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void GraphRegistry::enqueue(const Handle& graph, std::function<void(Graph&)> fn, Completion done) {
+    {
+        std::lock_guard<std::mutex> lock(graph->pendingMtx);
+        graph->pending.push_back({std::move(fn), std::move(done)});
+        if (graph->drainScheduled) return;  // The queued drain will pick it up
+        graph->drainScheduled = true;
+    }
+
+    // The task holds its own handle, so a concurrent drop cannot free the graph under it
+    Shard& shard = *shards[graph->shard];
+    std::lock_guard<std::mutex> lock(shard.submitMtx);
+    shard.worker.submit([graph]() { drain(*graph); });
+}
+
+// Completion that settles the promise; the promise moves into it, so callers take the
+// future first
+GraphRegistry::Completion GraphRegistry::fulfil(std::promise<void>& promise) {
+    auto shared = std::make_shared<std::promise<void>>(std::move(promise));
+    return [shared](std::exception_ptr error) {
+        if (error) {
+            shared->set_exception(error);
+        } else {
+            shared->set_value();
+        }
+    };
+}
+
+void GraphRegistry::drain(GraphEntry& graph) {
+    std::vector<GraphEntry::Mutation> batch;
+    {
+        std::lock_guard<std::mutex> lock(graph.pendingMtx);
+        batch.swap(graph.pending);
+        graph.drainScheduled = false;
+    }
+    Metrics::record(BATCH_SIZE, batch.size());
+
+    // A mutation that throws fails only its own request; the rest of the batch still lands
+    std::vector<std::exception_ptr> failures(batch.size());
+    try {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now(), applied = start;
+        graph.store.update([&](Graph& next) {
+            Clock::time_point copied = Clock::now();
+            Metrics::record(COPY_TIME, Metrics::nanosSince(start));
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                try {
+                    batch[i].apply(next);
+                } catch (...) {
+                    failures[i] = std::current_exception();
+                }
+            }
+            applied = Clock::now();
+            Metrics::record(APPLY_TIME, static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(applied - copied).count()));
+        });
+        Metrics::record(PUBLISH_TIME, Metrics::nanosSince(applied));
+    } catch (...) {
+        for (auto& failure : failures) {
+            if (!failure) failure = std::current_exception();
+        }
+    }
+    for (std::size_t i = 0; i < batch.size(); ++i) batch[i].done(failures[i]);
+}
+
+std::future<void> GraphRegistry::update(const Handle& graph, std::function<void(Graph&)> fn) {
+    std::promise<void> promise;
+    std::future<void> result = promise.get_future();
+    enqueue(graph, std::move(fn), fulfil(promise));
+    return result;
+}
+
+void GraphRegistry::update(const Handle& graph, std::function<void(Graph&)> fn, Completion done) {
+    enqueue(graph, std::move(fn), std::move(done));
+}
+
+std::future<void> GraphRegistry::reset(const Handle& graph, int V) {
+    std::promise<void> promise;
+    std::future<void> result = promise.get_future();
+    reset(graph, V, fulfil(promise));
+    return result;
+}
+
+void GraphRegistry::reset(const Handle& graph, int V, Completion done) {
+    enqueue(graph, [V](Graph& next) { next = Graph(V); }, std::move(done));
+}
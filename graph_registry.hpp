@@ -0,0 +1,113 @@
+#ifndef GRAPH_REGISTRY_HPP
+#define GRAPH_REGISTRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "active_object.hpp"
+#include "graph_store.hpp"
+
+// One named graph. New versions are only ever published by the graph's shard worker, so
+// writes to the same graph run one after another, while readers take snapshots directly.
+struct GraphEntry {
+    GraphEntry(const std::string& name, unsigned shard) : name(name), shard(shard) {}
+
+    const std::string name;
+    const unsigned shard;
+    GraphStore store;
+    std::atomic<bool> dropped{false};  // Set once the name no longer leads here
+
+private:
+    friend class GraphRegistry;
+
+    struct Mutation {
+        std::function<void(Graph&)> apply;
+        std::function<void(std::exception_ptr)> done;
+    };
+
+    // Mutations waiting for the shard; all of them are applied to one copy of the graph and
+    // published as a single version, so a burst of small writes costs one copy and one publish
+    std::mutex pendingMtx;
+    std::vector<Mutation> pending;
+    bool drainScheduled = false;
+};
+
+// Registry of named graphs spread over a fixed set of shard workers.
+// A graph is pinned at creation to the shard holding the fewest graphs and every mutation of
+// it runs on that shard's thread, so changes to different graphs proceed in parallel without
+// sharing a lock. The name table is only locked by create/open/drop: sessions keep a handle
+// to their current graph and touch no shared state on ordinary requests.
+class GraphRegistry {
+public:
+    using Handle = std::shared_ptr<GraphEntry>;
+    // Told a mutation's outcome: nullptr once it is published, else what it threw
+    using Completion = std::function<void(std::exception_ptr)>;
+
+    static const char* const DEFAULT_GRAPH;  // Created up front and never dropped
+    static const std::size_t MAX_NAME_LENGTH = 64;
+
+    explicit GraphRegistry(unsigned numShards = 0);  // 0 means one shard per hardware thread
+    ~GraphRegistry();
+
+    GraphRegistry(const GraphRegistry&) = delete;
+    GraphRegistry& operator=(const GraphRegistry&) = delete;
+
+    // nullptr when the name or vertex count (0..Graph::vertexLimit()) is invalid or the name
+    // is already taken
+    Handle create(const std::string& name, int V);
+
+    // nullptr when no graph has this name
+    Handle open(const std::string& name) const;
+
+    // Forget a graph; sessions still holding it see it as dropped. The default graph stays.
+    bool drop(const std::string& name);
+
+    std::vector<std::string> names() const;
+    unsigned shardCount() const { return static_cast<unsigned>(shards.size()); }
+
+    // Run fn on the graph's shard against a copy of the current version and publish the
+    // result; the future becomes ready once the new version is visible to readers. Mutations
+    // queued while the shard is busy are applied together, in order. If fn throws, the
+    // future carries the exception and fn should have left the graph as it was.
+    std::future<void> update(const Handle& graph, std::function<void(Graph&)> fn);
+
+    // Like update, but instead of a future, done is called on the shard thread once the
+    // mutation was published or failed; callers that must not block on the outcome use this
+    void update(const Handle& graph, std::function<void(Graph&)> fn, Completion done);
+
+    // Replace the graph with an empty one of V vertices, on its shard; a count above
+    // Graph::vertexLimit() fails the future with std::length_error
+    std::future<void> reset(const Handle& graph, int V);
+    void reset(const Handle& graph, int V, Completion done);
+
+    // Names are 1..MAX_NAME_LENGTH characters from [A-Za-z0-9_.-]
+    static bool isValidName(const std::string& name);
+
+private:
+    // ActiveObject rings take a single producer, so submissions from the many client threads
+    // are serialized by submitMtx; the work itself runs outside it
+    struct Shard {
+        std::mutex submitMtx;
+        ActiveObject worker;
+        std::size_t graphs = 0;  // Guarded by the registry mutex
+    };
+
+    mutable std::shared_mutex mtx;
+    std::unordered_map<std::string, Handle> graphs;
+    std::vector<std::unique_ptr<Shard>> shards;
+    int graphsGauge = -1;  // Metrics gauge reporting graphs.size()
+
+    void enqueue(const Handle& graph, std::function<void(Graph&)> fn, Completion done);
+    static Completion fulfil(std::promise<void>& promise);
+    static void drain(GraphEntry& graph);
+};
+
+#endif  // GRAPH_REGISTRY_HPP
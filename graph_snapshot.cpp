@@ -0,0 +1,347 @@
+#include "graph_snapshot.hpp"
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[8] = {'M', 'S', 'T', 'S', 'N', 'A', 'P', '\0'};
+const std::uint32_t BYTE_ORDER_TAG = 0x01020304;
+
+enum Section { EDGES, OFFSETS, NEIGHBORS, WEIGHTS, MST, STATS, SECTION_COUNT };
+
+// Fixed-width mirror of MSTStats
+struct StatsRecord {
+    std::uint64_t edgeCount;
+    std::int64_t totalWeight;
+    std::int32_t heaviestEdge;
+    std::int32_t lightestEdge;
+    std::int64_t diameter;
+    std::int64_t shortestDistance;
+    double averageDistance;
+    std::uint64_t pairCount;
+};
+static_assert(sizeof(StatsRecord) == 56, "StatsRecord must have no padding");
+static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "CSR offsets are stored as they are in memory");
+
+std::uint64_t align8(std::uint64_t n) { return (n + 7) & ~std::uint64_t(7); }
+
+// Word-wise multiply-rotate hash over four independent lanes, so it runs near memory speed
+std::uint64_t hashBytes(const char* data, std::size_t size, std::uint64_t seed) {
+    const std::uint64_t PRIME = 0x9E3779B97F4A7C15ULL;
+    std::uint64_t lanes[4] = {seed, seed ^ 0x1, seed ^ 0x2, seed ^ 0x3};
+    auto mix = [PRIME](std::uint64_t lane, std::uint64_t word) {
+        lane = (lane ^ word) * PRIME;
+        return (lane << 31) | (lane >> 33);
+    };
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i + 8 * k, 8);
+            lanes[k] = mix(lanes[k], word);
+        }
+    }
+    std::uint64_t hash = mix(mix(mix(mix(size, lanes[0]), lanes[1]), lanes[2]), lanes[3]);
+    for (; i < size; ++i) hash = mix(hash, static_cast<unsigned char>(data[i]));
+    return hash;
+}
+
+}  // namespace
+
+struct GraphSnapshot::Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;   // BYTE_ORDER_TAG as laid out by the writing host
+    std::uint32_t headerSize;
+    std::int32_t vertices;
+    std::int32_t maxEdgeWeight;
+    std::int32_t minEdgeWeight;
+    std::uint64_t edgeCount;
+    std::uint64_t mstEdgeCount;
+    std::uint64_t fileSize;
+    std::uint64_t checksum;    // Over the header with this field zeroed, then every section
+    std::uint64_t sectionOffset[SECTION_COUNT];
+    std::uint64_t sectionSize[SECTION_COUNT];
+};
+static_assert(sizeof(GraphSnapshot::Header) == 160, "Header must have no padding");
+
+namespace {
+
+std::uint64_t checksumOf(GraphSnapshot::Header header, const char* const* sections) {
+    header.checksum = 0;
+    std::uint64_t hash = hashBytes(reinterpret_cast<const char*>(&header), sizeof(header), 0);
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        hash = hashBytes(sections[s], header.sectionSize[s], hash);
+    }
+    return hash;
+}
+
+std::vector<std::int32_t> packEdges(const std::vector<std::tuple<int, int, int>>& edges) {
+    std::vector<std::int32_t> packed(3 * edges.size());
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        std::tie(packed[3 * i], packed[3 * i + 1], packed[3 * i + 2]) = edges[i];
+    }
+    return packed;
+}
+
+std::vector<std::tuple<int, int, int>> unpackEdges(const std::int32_t* packed, std::size_t count) {
+    std::vector<std::tuple<int, int, int>> edges(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        edges[i] = std::make_tuple(packed[3 * i], packed[3 * i + 1], packed[3 * i + 2]);
+    }
+    return edges;
+}
+
+// writev until every byte is out, resuming after partial writes
+bool writeAll(int fd, std::vector<iovec> parts) {
+    std::size_t next = 0;
+    while (next < parts.size()) {
+        ssize_t n = writev(fd, parts.data() + next, static_cast<int>(parts.size() - next));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        std::size_t left = static_cast<std::size_t>(n);
+        while (next < parts.size() && left >= parts[next].iov_len) left -= parts[next++].iov_len;
+        if (left > 0) {
+            parts[next].iov_base = static_cast<char*>(parts[next].iov_base) + left;
+            parts[next].iov_len -= left;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+GraphSnapshot::Result GraphSnapshot::save(const Graph& graph, const std::string& path) {
+    Result result;
+    const MSTStats* stats = graph.stats.peek(graph.mst.version());
+    if (graph.overlayEntries != 0 || graph.tombstones != 0 || !graph.mst.isValid() || stats == nullptr) {
+        result.error = "graph is not frozen";
+        return result;
+    }
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    result.error = "snapshots are only written on little-endian hosts";
+    return result;
+#endif
+
+    std::vector<std::int32_t> edges = packEdges(graph.mstEdges);
+    std::vector<std::int32_t> tree = packEdges(graph.mst.edges());
+    StatsRecord record{stats->edgeCount, stats->totalWeight, stats->heaviestEdge, stats->lightestEdge,
+                       stats->diameter, stats->shortestDistance, stats->averageDistance, stats->pairCount};
+
+    const char* sections[SECTION_COUNT] = {
+        reinterpret_cast<const char*>(edges.data()),
+        reinterpret_cast<const char*>(graph.csrOffsets.data()),
+        reinterpret_cast<const char*>(graph.csrNeighbors.data()),
+        reinterpret_cast<const char*>(graph.csrWeights.data()),
+        reinterpret_cast<const char*>(tree.data()),
+        reinterpret_cast<const char*>(&record)};
+    std::uint64_t sizes[SECTION_COUNT] = {
+        4 * edges.size(), 8 * graph.csrOffsets.size(), 4 * graph.csrNeighbors.size(),
+        4 * graph.csrWeights.size(), 4 * tree.size(), sizeof(record)};
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_TAG;
+    header.headerSize = sizeof(Header);
+    header.vertices = graph.V;
+    header.maxEdgeWeight = graph.maxEdgeWeight;
+    header.minEdgeWeight = graph.minEdgeWeight;
+    header.edgeCount = graph.mstEdges.size();
+    header.mstEdgeCount = graph.mst.edges().size();
+
+    static const char padding[8] = {0};
+    std::vector<iovec> parts;
+    parts.push_back({&header, sizeof(header)});
+    std::uint64_t offset = sizeof(Header);
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        header.sectionOffset[s] = offset;
+        header.sectionSize[s] = sizes[s];
+        if (sizes[s] > 0) parts.push_back({const_cast<char*>(sections[s]), sizes[s]});
+        std::uint64_t padded = align8(sizes[s]);
+        if (padded > sizes[s]) parts.push_back({const_cast<char*>(padding), padded - sizes[s]});
+        offset += padded;
+    }
+    header.fileSize = offset;
+    header.checksum = checksumOf(header, sections);
+
+    // Write beside the target and rename, so readers never see a half-written snapshot
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        result.error = std::string("cannot create file: ") + std::strerror(errno);
+        return result;
+    }
+    bool written = writeAll(fd, parts) && fsync(fd) == 0;
+    int savedErrno = errno;
+    written = ::close(fd) == 0 && written;
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        result.error = std::string("cannot write file: ") + std::strerror(written ? errno : savedErrno);
+        ::unlink(temporary.c_str());
+        return result;
+    }
+
+    result.ok = true;
+    result.vertices = graph.V;
+    result.edges = graph.mstEdges.size();
+    return result;
+}
+
+GraphSnapshot::Result GraphSnapshot::open(const std::string& path) {
+    Result result;
+    header = nullptr;
+    if (!file.open(path)) {
+        result.error = std::string("cannot open file: ") + std::strerror(errno);
+        return result;
+    }
+
+    const Header* candidate = reinterpret_cast<const Header*>(file.data());
+    std::uint64_t size = file.size();
+    if (size < sizeof(Header) || std::memcmp(candidate->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        result.error = "not a graph snapshot";
+        return result;
+    }
+    if (candidate->version != VERSION || candidate->headerSize != sizeof(Header)) {
+        result.error = "unsupported snapshot version " + std::to_string(candidate->version);
+        return result;
+    }
+    if (candidate->byteOrder != BYTE_ORDER_TAG) {
+        result.error = "snapshot was written with a different byte order";
+        return result;
+    }
+    if (candidate->fileSize != size) {
+        result.error = "truncated snapshot";
+        return result;
+    }
+
+    // Every section must lie inside the file, be aligned and have the size its counts imply
+    std::uint64_t V = candidate->vertices < 0 ? 0 : static_cast<std::uint64_t>(candidate->vertices);
+    std::uint64_t expected[SECTION_COUNT] = {12 * candidate->edgeCount, 8 * (V + 1), 0, 0,
+                                             12 * candidate->mstEdgeCount, sizeof(StatsRecord)};
+    const char* sections[SECTION_COUNT];
+    bool ok = candidate->vertices >= 0;
+    for (int s = 0; s < SECTION_COUNT && ok; ++s) {
+        std::uint64_t begin = candidate->sectionOffset[s], length = candidate->sectionSize[s];
+        ok = begin % 8 == 0 && begin >= sizeof(Header) && begin <= size && length <= size - begin;
+        sections[s] = file.data() + begin;
+    }
+    if (ok) {
+        const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(sections[OFFSETS]);
+        ok = candidate->sectionSize[OFFSETS] == expected[OFFSETS];
+        expected[NEIGHBORS] = expected[WEIGHTS] = ok ? 4 * offsets[V] : 0;
+        for (int s = 0; s < SECTION_COUNT && ok; ++s) ok = candidate->sectionSize[s] == expected[s];
+    }
+    if (!ok) {
+        result.error = "corrupt snapshot layout";
+        return result;
+    }
+    if (checksumOf(*candidate, sections) != candidate->checksum) {
+        result.error = "snapshot checksum mismatch";
+        return result;
+    }
+
+    // The checksum guards against damage; these guard restore() against a crafted file
+    const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(sections[OFFSETS]);
+    ok = offsets[0] == 0;
+    for (std::uint64_t u = 0; u < V && ok; ++u) ok = offsets[u] <= offsets[u + 1];
+    const std::int32_t* neighbors = reinterpret_cast<const std::int32_t*>(sections[NEIGHBORS]);
+    for (std::uint64_t i = 0; i < offsets[V] && ok; ++i) ok = neighbors[i] >= 0 && neighbors[i] < candidate->vertices;
+    const std::int32_t* lists[2] = {reinterpret_cast<const std::int32_t*>(sections[EDGES]),
+                                    reinterpret_cast<const std::int32_t*>(sections[MST])};
+    std::uint64_t counts[2] = {candidate->edgeCount, candidate->mstEdgeCount};
+    for (int l = 0; l < 2 && ok; ++l) {
+        for (std::uint64_t i = 0; i < counts[l] && ok; ++i) {
+            std::int32_t u = lists[l][3 * i + 1], v = lists[l][3 * i + 2];
+            ok = u >= 0 && v >= 0 && u < candidate->vertices && v < candidate->vertices;
+        }
+    }
+    if (!ok) {
+        result.error = "snapshot references vertices out of range";
+        return result;
+    }
+
+    if (candidate->vertices > Graph::vertexLimit()) {
+        result.error = "snapshot has more vertices than the limit of " + std::to_string(Graph::vertexLimit());
+        return result;
+    }
+
+    header = candidate;
+    result.ok = true;
+    result.vertices = header->vertices;
+    result.edges = header->edgeCount;
+    return result;
+}
+
+const char* GraphSnapshot::section(int index) const { return file.data() + header->sectionOffset[index]; }
+
+int GraphSnapshot::vertices() const { return header->vertices; }
+std::size_t GraphSnapshot::edgeCount() const { return header->edgeCount; }
+std::size_t GraphSnapshot::mstEdgeCount() const { return header->mstEdgeCount; }
+
+const std::int32_t* GraphSnapshot::edges() const { return reinterpret_cast<const std::int32_t*>(section(EDGES)); }
+const std::uint64_t* GraphSnapshot::offsets() const { return reinterpret_cast<const std::uint64_t*>(section(OFFSETS)); }
+const std::int32_t* GraphSnapshot::neighbors() const { return reinterpret_cast<const std::int32_t*>(section(NEIGHBORS)); }
+const std::int32_t* GraphSnapshot::weights() const { return reinterpret_cast<const std::int32_t*>(section(WEIGHTS)); }
+const std::int32_t* GraphSnapshot::mstEdges() const { return reinterpret_cast<const std::int32_t*>(section(MST)); }
+
+MSTStats GraphSnapshot::stats() const {
+    StatsRecord record;
+    std::memcpy(&record, section(STATS), sizeof(record));
+    MSTStats stats;
+    stats.edgeCount = record.edgeCount;
+    stats.totalWeight = record.totalWeight;
+    stats.heaviestEdge = record.heaviestEdge;
+    stats.lightestEdge = record.lightestEdge;
+    stats.diameter = record.diameter;
+    stats.shortestDistance = record.shortestDistance;
+    stats.averageDistance = record.averageDistance;
+    stats.pairCount = record.pairCount;
+    return stats;
+}
+
+void GraphSnapshot::restore(Graph& graph) const {
+    int V = vertices();
+    Graph restored(V);
+    restored.mstEdges = unpackEdges(edges(), edgeCount());
+    restored.csrOffsets.assign(offsets(), offsets() + V + 1);
+    std::size_t adjacency = restored.csrOffsets[V];
+    restored.csrNeighbors.assign(neighbors(), neighbors() + adjacency);
+    restored.csrWeights.assign(weights(), weights() + adjacency);
+    restored.maxEdgeWeight = header->maxEdgeWeight;
+    restored.minEdgeWeight = header->minEdgeWeight;
+    // Zero bounds on a graph without edges mean no weight was ever added (or only zeros,
+    // which the bounds cannot tell apart and which behave the same)
+    restored.weighted = header->edgeCount > 0 || header->maxEdgeWeight != 0 || header->minEdgeWeight != 0;
+
+    restored.mst.adopt(unpackEdges(mstEdges(), mstEdgeCount()));
+    restored.stats.put(restored.mst.version(), stats());
+    graph = std::move(restored);  // The path index is built by the first path query
+}
+
+std::function<void(Graph&)> GraphSnapshot::loadInto(const std::string& path, std::shared_ptr<Result> result) {
+    return [path, result](Graph& graph) {
+        GraphSnapshot snapshot;
+        *result = snapshot.open(path);
+        if (result->ok) snapshot.restore(graph);
+    };
+}
+
+std::function<void(Graph&)> GraphSnapshot::saveFrom(const std::string& path, std::shared_ptr<Result> result) {
+    return [path, result](Graph& graph) {
+        graph.freeze();
+        *result = save(graph, path);
+    };
+}
+
+std::string GraphSnapshot::describe(const Result& result, const std::string& path, bool saved) {
+    if (!result.ok) return std::string(saved ? "Failed to save '" : "Failed to load '") + path + "': " + result.error;
+    return std::string(saved ? "Saved snapshot '" : "Loaded snapshot '") + path + "' (" +
+           std::to_string(result.vertices) + " vertices, " + std::to_string(result.edges) + " edges)";
+}
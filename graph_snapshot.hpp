@@ -0,0 +1,66 @@
+#ifndef GRAPH_SNAPSHOT_HPP
+#define GRAPH_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "graph.hpp"
+#include "mapped_file.hpp"
+
+// Versioned, checksummed on-disk image of a frozen graph: its edge list, CSR adjacency, MST
+// and MST statistics. The file is a fixed header followed by 8-byte aligned sections in host
+// layout (little-endian only), written with one writev and opened through mmap. Every
+// accessor below reads straight out of the mapping; restore() bulk-copies the arrays into a
+// Graph and adopts the stored MST and statistics instead of recomputing them.
+class GraphSnapshot {
+public:
+    static const std::uint32_t VERSION = 1;
+    struct Header;  // On-disk layout, defined in graph_snapshot.cpp
+
+    struct Result {
+        bool ok = false;
+        std::string error;
+        int vertices = 0;
+        std::size_t edges = 0;
+    };
+
+    // Write a frozen graph (see Graph::freeze) to path, replacing it atomically
+    static Result save(const Graph& graph, const std::string& path);
+
+    // Map and verify a snapshot
+    Result open(const std::string& path);
+
+    int vertices() const;
+    std::size_t edgeCount() const;
+    const std::int32_t* edges() const;      // edgeCount() x (weight, u, v)
+    const std::uint64_t* offsets() const;   // vertices() + 1 CSR offsets
+    const std::int32_t* neighbors() const;  // offsets()[vertices()] entries
+    const std::int32_t* weights() const;
+    std::size_t mstEdgeCount() const;
+    const std::int32_t* mstEdges() const;   // mstEdgeCount() x (weight, u, v)
+    MSTStats stats() const;
+
+    // Rebuild the mapped graph, compacted and with its stored MST and statistics adopted
+    void restore(Graph& graph) const;
+
+    // Mutation for GraphRegistry::update that replaces the graph with a snapshot file and
+    // reports into result; a failed load leaves the graph as it was
+    static std::function<void(Graph&)> loadInto(const std::string& path, std::shared_ptr<Result> result);
+
+    // Mutation that saves the graph as it stands at that point of its shard's queue, so a
+    // save is ordered with the writes around it
+    static std::function<void(Graph&)> saveFrom(const std::string& path, std::shared_ptr<Result> result);
+
+    // One-line summary for logs and client replies
+    static std::string describe(const Result& result, const std::string& path, bool saved);
+
+private:
+    MappedFile file;
+    const Header* header = nullptr;
+
+    const char* section(int index) const;
+};
+
+#endif  // GRAPH_SNAPSHOT_HPP
@@ -0,0 +1,46 @@
+#ifndef GRAPH_STORE_HPP
+#define GRAPH_STORE_HPP
+
+#include <memory>
+#include <utility>
+#include "graph.hpp"
+#include "rcu.hpp"
+
+// Snapshot-isolated home of a shared graph.
+// Readers pin the current immutable version without locking and query it through Graph's
+// const methods. Writers copy the current version, mutate the copy and publish it
+// atomically; writers are serialized among themselves but never block readers.
+// Every publish copies the whole graph (CSR arrays, overlay, edge list and maintained
+// forest), so it costs O(V + E) however small the change. It rebuilds nothing, though: the
+// overlay is only compacted when it crosses its size threshold, and an invalidated MST, the
+// path index and the statistics are built by the first reader that asks for them (see
+// Graph::settle). Callers amortize the copy by batching: GraphRegistry::drain applies every
+// mutation queued for a graph to one copy, and both servers queue a client's pipelined
+// edge updates before waiting for any of them.
+class GraphStore {
+public:
+    using Snapshot = RcuCell<Graph>::ReadGuard;
+
+    explicit GraphStore(int V = 0) : cell(std::unique_ptr<Graph>(new Graph(V))) {}
+
+    Snapshot snapshot() const { return cell.read(); }
+
+    // Apply fn(Graph&) to a copy of the current version and publish the result
+    template <typename Fn>
+    void update(Fn&& fn) {
+        cell.update([&fn](const Graph& current) {
+            std::unique_ptr<Graph> next(new Graph(current));
+            next->settle();
+            fn(*next);
+            return next;
+        });
+    }
+
+    // Publish a fresh graph, dropping the current one
+    void reset(Graph graph) { cell.publish(std::unique_ptr<Graph>(new Graph(std::move(graph)))); }
+
+private:
+    RcuCell<Graph> cell;
+};
+
+#endif  // GRAPH_STORE_HPP
@@ -0,0 +1,95 @@
+#ifndef INDEXED_HEAP_HPP
+#define INDEXED_HEAP_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Indexed d-ary min-heap over the ids 0..n-1 with a real decrease-key.
+// pos[id] tracks where each id sits in the heap, so every id appears at most once.
+template <typename Key, int D = 4>
+class IndexedDaryHeap {
+    std::vector<int> heap;  // Heap-ordered ids
+    std::vector<int> pos;   // Position of each id in heap, -1 when absent
+    std::vector<Key> keys;
+
+    void place(std::size_t i, int id) {
+        heap[i] = id;
+        pos[id] = static_cast<int>(i);
+    }
+
+    void siftUp(std::size_t i) {
+        int id = heap[i];
+        while (i > 0) {
+            std::size_t parent = (i - 1) / D;
+            if (!(keys[id] < keys[heap[parent]])) break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, id);
+    }
+
+    void siftDown(std::size_t i) {
+        int id = heap[i];
+        std::size_t n = heap.size();
+        while (true) {
+            std::size_t first = i * D + 1;
+            if (first >= n) break;
+            std::size_t last = first + D < n ? first + D : n;
+            std::size_t best = first;
+            for (std::size_t c = first + 1; c < last; ++c) {
+                if (keys[heap[c]] < keys[heap[best]]) best = c;
+            }
+            if (!(keys[heap[best]] < keys[id])) break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, id);
+    }
+
+public:
+    explicit IndexedDaryHeap(int n) : pos(n, -1), keys(n) {}
+
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+    bool contains(int id) const { return pos[id] >= 0; }
+    const Key& key(int id) const { return keys[id]; }
+    int top() const { return heap.front(); }
+
+    void push(int id, const Key& key) {
+        keys[id] = key;
+        heap.push_back(id);
+        pos[id] = static_cast<int>(heap.size() - 1);
+        siftUp(heap.size() - 1);
+    }
+
+    // Lower the key of an id already in the heap
+    void decreaseKey(int id, const Key& key) {
+        keys[id] = key;
+        siftUp(static_cast<std::size_t>(pos[id]));
+    }
+
+    // Insert id or lower its key; returns false when the current key is already smaller or equal
+    bool pushOrDecrease(int id, const Key& key) {
+        if (!contains(id)) {
+            push(id, key);
+            return true;
+        }
+        if (!(key < keys[id])) return false;
+        decreaseKey(id, key);
+        return true;
+    }
+
+    int pop() {
+        int id = heap.front();
+        pos[id] = -1;
+        int lastId = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            place(0, lastId);
+            siftDown(0);
+        }
+        return id;
+    }
+};
+
+#endif  // INDEXED_HEAP_HPP
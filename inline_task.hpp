@@ -0,0 +1,111 @@
+#ifndef INLINE_TASK_HPP
+#define INLINE_TASK_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only void() callable with Capacity bytes of in-place storage.
+// Callables that fit (size, alignment and a non-throwing move) live inside the object, so
+// storing a task in a preallocated ring slot never touches the allocator; larger ones fall
+// back to a single heap allocation, like std::function. Unlike std::function the callable
+// does not need to be copyable.
+template <std::size_t Capacity>
+class InlineTask {
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* to, void* from);  // Move-construct into `to`, destroy `from`
+        void (*destroy)(void* storage);
+    };
+
+    template <typename F>
+    static constexpr bool fitsInline() {
+        return sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    template <typename F>
+    static const Ops* inlineOps() {
+        static const Ops ops = {
+            [](void* s) { (*static_cast<F*>(s))(); },
+            [](void* to, void* from) {
+                new (to) F(std::move(*static_cast<F*>(from)));
+                static_cast<F*>(from)->~F();
+            },
+            [](void* s) { static_cast<F*>(s)->~F(); }};
+        return &ops;
+    }
+
+    template <typename F>
+    static const Ops* heapOps() {
+        static const Ops ops = {
+            [](void* s) { (**static_cast<F**>(s))(); },
+            [](void* to, void* from) { *static_cast<F**>(to) = *static_cast<F**>(from); },
+            [](void* s) { delete *static_cast<F**>(s); }};
+        return &ops;
+    }
+
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    const Ops* ops = nullptr;
+
+    void reset() {
+        if (ops != nullptr) ops->destroy(storage);
+        ops = nullptr;
+    }
+
+    template <typename Fn, typename F>
+    void construct(F&& fn, std::true_type /* inline */) {
+        new (storage) Fn(std::forward<F>(fn));
+        ops = inlineOps<Fn>();
+    }
+
+    template <typename Fn, typename F>
+    void construct(F&& fn, std::false_type /* inline */) {
+        *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(fn));
+        ops = heapOps<Fn>();
+    }
+
+public:
+    static_assert(Capacity >= sizeof(void*), "InlineTask needs room for at least a pointer");
+
+    InlineTask() = default;
+    InlineTask(std::nullptr_t) {}
+
+    template <typename F, typename Fn = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Fn, InlineTask>::value>::type>
+    InlineTask(F&& fn) {
+        construct<Fn>(std::forward<F>(fn), std::integral_constant<bool, fitsInline<Fn>()>());
+    }
+
+    InlineTask(InlineTask&& other) noexcept : ops(other.ops) {
+        if (ops != nullptr) ops->relocate(storage, other.storage);
+        other.ops = nullptr;
+    }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops != nullptr) ops->relocate(storage, other.storage);
+            other.ops = nullptr;
+        }
+        return *this;
+    }
+
+    InlineTask& operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask() { reset(); }
+
+    explicit operator bool() const { return ops != nullptr; }
+
+    void operator()() { ops->invoke(storage); }
+};
+
+#endif  // INLINE_TASK_HPP
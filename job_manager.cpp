@@ -0,0 +1,157 @@
+#include "job_manager.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include "metrics.hpp"
+#include "mst_factory.hpp"
+#include "parallel.hpp"
+#include "shortest_path.hpp"
+
+constexpr std::chrono::milliseconds JobManager::DEFAULT_TIMEOUT;
+constexpr std::chrono::milliseconds JobManager::MAX_TIMEOUT;
+
+namespace {
+
+// Time from starting a job to its finish, whatever the outcome
+const int JOB_TIME = Metrics::histogram("compute.job");
+const int JOBS_DONE = Metrics::counter("jobs.done");
+const int JOBS_CANCELLED = Metrics::counter("jobs.cancelled");
+const int JOBS_EXPIRED = Metrics::counter("jobs.expired");
+
+}  // namespace
+
+JobManager::JobManager(unsigned numRunners) {
+    unsigned count = numRunners > 0 ? numRunners : std::max(1u, resolveThreadCount(0) / 2);
+    for (unsigned i = 0; i < count; ++i) runners.emplace_back(&JobManager::run, this);
+    gauge = Metrics::gauge("jobs.active", [this]() {
+        std::lock_guard<std::mutex> lock(mtx);
+        long long active = 0;
+        for (const auto& entry : jobs) active += finished(entry.second->state) ? 0 : 1;
+        return active;
+    });
+}
+
+JobManager::~JobManager() {
+    Metrics::removeGauge(gauge);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+        for (auto& entry : jobs) entry.second->token.cancel();
+    }
+    wakeup.notify_all();
+    for (auto& runner : runners) runner.join();
+}
+
+std::uint64_t JobManager::submit(GraphRegistry::Handle graph, const JobSpec& spec, std::chrono::milliseconds timeout) {
+    if (timeout.count() <= 0) timeout = DEFAULT_TIMEOUT;
+    timeout = std::min(timeout, MAX_TIMEOUT);
+    std::uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        id = nextId++;
+        auto job = std::make_shared<Job>(id, std::move(graph), spec, CancelToken::Clock::now() + timeout);
+        jobs.emplace(id, job);
+        queue.push_back(std::move(job));
+    }
+    wakeup.notify_one();
+    return id;
+}
+
+bool JobManager::status(std::uint64_t id, State& state) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return false;
+    state = it->second->state;
+    return true;
+}
+
+bool JobManager::result(std::uint64_t id, State& state, JobResult& out) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return false;
+    state = it->second->state;
+    if (finished(state)) {
+        out = it->second->result;
+        jobs.erase(it);
+    }
+    return true;
+}
+
+bool JobManager::cancel(std::uint64_t id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = jobs.find(id);
+    if (it == jobs.end() || finished(it->second->state)) return false;
+    Job& job = *it->second;
+    job.token.cancel();
+    if (job.state == QUEUED) finish(job, CANCELLED);  // The runner that dequeues it skips it
+    return true;
+}
+
+const char* JobManager::stateName(State state) {
+    switch (state) {
+        case QUEUED: return "queued";
+        case RUNNING: return "running";
+        case DONE: return "done";
+        case CANCELLED: return "cancelled";
+        case EXPIRED: return "expired";
+    }
+    return "unknown";
+}
+
+void JobManager::finish(Job& job, State state) {
+    job.state = state;
+    job.graph.reset();
+    Metrics::add(state == DONE ? JOBS_DONE : state == CANCELLED ? JOBS_CANCELLED : JOBS_EXPIRED);
+    finishedOrder.push_back(job.id);
+    while (finishedOrder.size() > MAX_FINISHED) {
+        jobs.erase(finishedOrder.front());  // No-op if the result was fetched already
+        finishedOrder.pop_front();
+    }
+}
+
+JobResult JobManager::compute(const Job& job) {
+    // Read the version current at the start straight from the store; the shard keeps
+    // publishing meanwhile, since readers never block writers
+    GraphStore::Snapshot snapshot = job.graph->store.snapshot();
+    const Graph& graph = *snapshot;
+    JobResult result;
+    result.kind = job.spec.kind;
+    if (job.spec.kind == JobSpec::SHORTEST_PATH) {
+        result.value = ShortestPath::distance(graph, job.spec.start, job.spec.end, &job.token);
+        return result;
+    }
+    MSTOptions options;
+    options.verbose = false;
+    options.cancel = &job.token;
+    auto tree = MSTFactory::computeMST(graph, job.spec.algorithm, options);
+    for (const auto& edge : tree) result.value += std::get<0>(edge);
+    result.edges = tree.size();
+    return result;
+}
+
+void JobManager::run() {
+    setpriority(PRIO_PROCESS, 0, JOB_NICE);  // On Linux this applies to the calling thread only
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            wakeup.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;  // Stopping
+            job = std::move(queue.front());
+            queue.pop_front();
+            if (job->state != QUEUED) continue;  // Cancelled while it waited
+            if (stopping || job->token.stopRequested()) {
+                finish(*job, job->token.deadlinePassed() ? EXPIRED : CANCELLED);
+                continue;
+            }
+            job->state = RUNNING;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        JobResult result = compute(*job);
+        Metrics::record(JOB_TIME, Metrics::nanosSince(start));
+
+        std::lock_guard<std::mutex> lock(mtx);
+        job->result = result;
+        finish(*job, job->token.wasCancelled() ? CANCELLED : job->token.deadlinePassed() ? EXPIRED : DONE);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef JOB_MANAGER_HPP
+#define JOB_MANAGER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "cancel_token.hpp"
+#include "graph_registry.hpp"
+
+// What a background job computes
+struct JobSpec {
+    enum Kind { MST, SHORTEST_PATH };
+
+    Kind kind = MST;
+    std::string algorithm = "kruskal";  // MST jobs: any MSTFactory algorithm
+    int start = 0;                      // SHORTEST_PATH jobs
+    int end = 0;
+};
+
+// Outcome of a finished job: an MST's total weight and edge count, or a shortest distance
+// in `value` (-1 when unreachable)
+struct JobResult {
+    JobSpec::Kind kind = JobSpec::MST;
+    long long value = 0;
+    std::size_t edges = 0;
+};
+
+// Background MST and shortest-path jobs.
+// Submitting returns an id at once; the job runs later on one of a few low-priority runner
+// threads against the graph version published when it starts, so neither the client's
+// connection thread nor the graph's shard waits for it. The job pins that snapshot instead of
+// copying the graph; while it runs, versions retired after it started are only reclaimed
+// once it finishes, which the deadline bounds. Every job has a deadline counted from
+// submission. Cancelling, or reaching the deadline, fires the job's CancelToken,
+// which the algorithms poll inside their loops. Finished jobs keep their result until it is
+// fetched, up to MAX_FINISHED of them; the oldest are forgotten first.
+class JobManager {
+public:
+    enum State { QUEUED, RUNNING, DONE, CANCELLED, EXPIRED };
+
+    static const std::size_t MAX_FINISHED = 1024;
+    static const int JOB_NICE = 10;  // Runner threads yield the CPU to the connection threads
+    static constexpr std::chrono::milliseconds DEFAULT_TIMEOUT{60000};
+    static constexpr std::chrono::milliseconds MAX_TIMEOUT{3600000};
+
+    explicit JobManager(unsigned numRunners = 0);  // 0 means half the hardware threads, at least one
+    ~JobManager();
+
+    JobManager(const JobManager&) = delete;
+    JobManager& operator=(const JobManager&) = delete;
+
+    // A zero timeout means DEFAULT_TIMEOUT; longer ones are capped at MAX_TIMEOUT
+    std::uint64_t submit(GraphRegistry::Handle graph, const JobSpec& spec, std::chrono::milliseconds timeout);
+
+    // False for ids that are unknown or were already fetched
+    bool status(std::uint64_t id, State& state) const;
+
+    // The state and, once DONE, the result. Fetching a finished job forgets it.
+    bool result(std::uint64_t id, State& state, JobResult& out);
+
+    // Stop a queued or running job; false if it is unknown or already finished
+    bool cancel(std::uint64_t id);
+
+    static const char* stateName(State state);
+    static bool finished(State state) { return state == DONE || state == CANCELLED || state == EXPIRED; }
+
+private:
+    struct Job {
+        Job(std::uint64_t id, GraphRegistry::Handle graph, const JobSpec& spec, CancelToken::Clock::time_point deadline)
+            : id(id), graph(std::move(graph)), spec(spec), token(deadline) {}
+
+        const std::uint64_t id;
+        GraphRegistry::Handle graph;  // Released once the job finished
+        const JobSpec spec;
+        CancelToken token;
+        State state = QUEUED;  // Guarded by the manager mutex
+        JobResult result;
+    };
+
+    mutable std::mutex mtx;
+    std::condition_variable wakeup;
+    std::unordered_map<std::uint64_t, std::shared_ptr<Job>> jobs;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::deque<std::uint64_t> finishedOrder;  // Ids in the order they finished, for eviction
+    std::uint64_t nextId = 1;
+    bool stopping = false;
+    std::vector<std::thread> runners;
+    int gauge = -1;  // Metrics gauge reporting queued and running jobs
+
+    void run();
+    static JobResult compute(const Job& job);
+    void finish(Job& job, State state);  // Caller holds mtx
+};
+
+#endif  // JOB_MANAGER_HPP
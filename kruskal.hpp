@@ -2,12 +2,23 @@
 #define KRUSKAL_MST_HPP
 
 #include "graph.hpp"
+#include "cancel_token.hpp"
 #include <vector>
 #include <tuple>
 
 class KruskalMST {
 public:
-    std::vector<std::tuple<int, int, int>> computeMST(Graph& graph);
+    explicit KruskalMST(unsigned numThreads = 1, bool verbose = true, const CancelToken* cancel = nullptr);
+
+    std::vector<std::tuple<int, int, int>> computeMST(const Graph& graph);
+
+    // Filter-Kruskal: partitions around a pivot and skips sorting edges that close cycles
+    std::vector<std::tuple<int, int, int>> computeFilterMST(const Graph& graph);
+
+private:
+    unsigned numThreads;  // Threads used by the radix sort on large edge sets
+    bool verbose;         // Print every selected edge and the total weight
+    const CancelToken* cancel;  // Polled while scanning edges and between Filter-Kruskal partitions
 };
 
 #endif  // KRUSKAL_MST_HPP
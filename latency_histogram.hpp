@@ -0,0 +1,90 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// HDR-style log-linear histogram of non-negative integer values (nanoseconds, typically).
+// Values below 2^SUB_BITS are counted exactly; above that every power-of-two range is split
+// into 2^(SUB_BITS - 1) equal buckets, so any recorded value is reported within 1/64 (~1.6%)
+// of itself, over the whole 64-bit range, in under 4K counters. Recording is O(1) and two
+// histograms merge by adding counters, so each thread keeps its own and they are combined
+// once at the end.
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 7;
+    static const std::size_t SUB_COUNT = std::size_t(1) << SUB_BITS;
+    static const std::size_t HALF_COUNT = SUB_COUNT / 2;
+    static const std::size_t BUCKETS = SUB_COUNT + (64 - SUB_BITS) * HALF_COUNT;
+
+    LatencyHistogram() : counts(BUCKETS, 0) {}
+
+    static std::size_t bucketOf(std::uint64_t value) {
+        if (value < SUB_COUNT) return static_cast<std::size_t>(value);
+        int exponent = 63 - __builtin_clzll(value);  // >= SUB_BITS
+        int shift = exponent - (SUB_BITS - 1);
+        std::size_t sub = static_cast<std::size_t>(value >> shift) - HALF_COUNT;
+        return SUB_COUNT + static_cast<std::size_t>(exponent - SUB_BITS) * HALF_COUNT + sub;
+    }
+
+    // Largest value that lands in bucket, i.e. what percentiles report
+    static std::uint64_t bucketHigh(std::size_t bucket) {
+        if (bucket < SUB_COUNT) return bucket;
+        std::size_t k = bucket - SUB_COUNT;
+        int shift = static_cast<int>(k / HALF_COUNT) + 1;
+        std::uint64_t sub = HALF_COUNT + k % HALF_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void record(std::uint64_t value) {
+        ++counts[bucketOf(value)];
+        ++total;
+        sum += value;
+        maximum = std::max(maximum, value);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    // Add raw bucket counts, e.g. copied out of a histogram another thread keeps updating
+    void addCounts(const std::uint64_t* bucketCounts, std::uint64_t valueSum, std::uint64_t valueMax) {
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] += bucketCounts[i];
+            total += bucketCounts[i];
+        }
+        sum += valueSum;
+        maximum = std::max(maximum, valueMax);
+    }
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return maximum; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    // Smallest recorded value v such that a fraction q of all values are <= v (within bucket
+    // precision); 0 for an empty histogram
+    std::uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(q * total + 0.5);
+        rank = std::min(std::max<std::uint64_t>(rank, 1), total);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(bucketHigh(i), maximum);
+        }
+        return maximum;
+    }
+
+private:
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t maximum = 0;
+};
+
+#endif  // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,75 @@
+#ifndef LAZY_VALUE_HPP
+#define LAZY_VALUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Cache slot for a value derived from an object that many threads read at once, such as a
+// published Graph. The value is computed by the first caller that needs it, under a mutex so
+// racing callers compute it only once, and is tagged with a key: the version of whatever it
+// was derived from. Once ready it is read with a single acquire load.
+// Copies share the cached value instead of copying it, so copying the owner stays cheap and
+// a copy whose key has not moved keeps the cache. A lookup with a different key replaces
+// the value; that only happens on an owner that is not shared yet, since a shared owner
+// does not change and so always asks with the same key.
+template <typename T>
+class LazyValue {
+public:
+    LazyValue() = default;
+    LazyValue(const LazyValue& other) : entry(other.share()) { ready.store(entry.get(), std::memory_order_release); }
+    LazyValue& operator=(const LazyValue& other) {
+        if (this != &other) {
+            std::shared_ptr<const Entry> shared = other.share();
+            std::lock_guard<std::mutex> lock(mtx);
+            entry = std::move(shared);
+            ready.store(entry.get(), std::memory_order_release);
+        }
+        return *this;
+    }
+
+    // The value for key, running compute() -> T first if the cached one is missing or stale
+    template <typename Fn>
+    const T& get(unsigned long long key, Fn&& compute) const {
+        const Entry* current = ready.load(std::memory_order_acquire);
+        if (current != nullptr && current->key == key) return current->value;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!entry || entry->key != key) {
+            entry = std::make_shared<const Entry>(Entry{key, compute()});
+            ready.store(entry.get(), std::memory_order_release);
+        }
+        return entry->value;
+    }
+
+    // Store a value computed elsewhere under key; like a lookup with a new key, only for an
+    // owner that is not shared yet
+    void put(unsigned long long key, T value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        entry = std::make_shared<const Entry>(Entry{key, std::move(value)});
+        ready.store(entry.get(), std::memory_order_release);
+    }
+
+    // The cached value if it was computed for key, else nullptr
+    const T* peek(unsigned long long key) const {
+        const Entry* current = ready.load(std::memory_order_acquire);
+        return current != nullptr && current->key == key ? &current->value : nullptr;
+    }
+
+private:
+    struct Entry {
+        unsigned long long key;
+        T value;
+    };
+
+    mutable std::mutex mtx;
+    mutable std::shared_ptr<const Entry> entry;         // Guarded by mtx
+    mutable std::atomic<const Entry*> ready{nullptr};  // entry.get(), for the lock-free path
+
+    std::shared_ptr<const Entry> share() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return entry;
+    }
+};
+
+#endif  // LAZY_VALUE_HPP
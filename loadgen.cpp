@@ -0,0 +1,563 @@
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "binary_protocol.hpp"
+#include "latency_histogram.hpp"
+#include "spsc_ring.hpp"
+
+// Load generator for leader_follower_server (port 8081) and pipeline_server (port 8080).
+// Each of N connections switches to the binary protocol, creates and seeds its own named
+// graph (or shares the default one with --shared) and replays a weighted mix of commands:
+//   closed loop (default): every connection sends its next request once the previous one
+//                          is answered; latency is the round trip
+//   open loop (--rate R):  requests leave on a fixed schedule of R per second in total,
+//                          pipelined, whether or not earlier ones were answered; latency is
+//                          measured from the scheduled send time, so a stalled server is
+//                          charged for the requests it delayed (no coordinated omission)
+// Throughput and p50/p99/p99.9 latency are reported per command type.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace BinaryProtocol;
+
+enum OpType { OP_CREATE, OP_ADD, OP_REMOVE, OP_MST, OP_PATH, OP_SHORTEST, OP_STATS, OP_COUNT };
+
+const char* const OP_NAMES[OP_COUNT] = {"create", "add", "remove", "mst", "path", "shortest", "stats"};
+
+// Edges per ADD_EDGES frame while seeding, well below MAX_FRAME_SIZE
+const std::size_t SEED_BATCH = 1 << 20;
+
+// How long an open-loop run waits for outstanding answers after its last send
+const std::chrono::seconds DRAIN_LIMIT(5);
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    int port = 8081;
+    int connections = 4;
+    double duration = 10;   // Seconds measured
+    double warmup = 1;      // Seconds run before measuring
+    double rate = 0;        // Requests per second over all connections; 0 = closed loop
+    int vertices = 10000;
+    std::size_t edges = 40000;
+    bool shared = false;
+    std::uint64_t seed = 1;
+    unsigned weights[OP_COUNT] = {1, 40, 10, 25, 15, 5, 4};
+};
+
+struct Random {
+    std::uint64_t state;
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    int below(std::uint64_t n) {
+        return static_cast<int>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+};
+
+void putU32(std::string& out, std::uint32_t value) {
+    char bytes[4] = {static_cast<char>(value), static_cast<char>(value >> 8), static_cast<char>(value >> 16),
+                     static_cast<char>(value >> 24)};
+    out.append(bytes, 4);
+}
+
+void beginFrame(std::string& out, std::uint8_t opcode, std::size_t payloadSize) {
+    putU32(out, static_cast<std::uint32_t>(payloadSize + 1));
+    out.push_back(static_cast<char>(opcode));
+}
+
+// Blocking client connection speaking the binary protocol
+class Connection {
+public:
+    Connection() = default;
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    ~Connection() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool open(const LoadConfig& config) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(config.port));
+        if (inet_pton(AF_INET, config.host.c_str(), &address.sin_addr) != 1) return false;
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) return false;
+
+        // The server sends its text menu, then echoes the preamble: skip up to the first NUL
+        if (!sendAll(std::string(PREAMBLE, PREAMBLE_SIZE))) return false;
+        while (true) {
+            if (!fill()) return false;
+            std::size_t nul = buffer.find('\0');
+            if (nul != std::string::npos && buffer.size() >= nul + PREAMBLE_SIZE) {
+                buffer.erase(0, nul + PREAMBLE_SIZE);
+                return true;
+            }
+        }
+    }
+
+    bool sendAll(const std::string& data) {
+        std::size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    // Read one response frame; its payload is discarded
+    bool readResponse(std::uint8_t& status) {
+        while (true) {
+            if (offset + 4 <= buffer.size()) {
+                const unsigned char* b = reinterpret_cast<const unsigned char*>(buffer.data() + offset);
+                std::uint32_t length = static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8 |
+                                       static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+                if (length < 2) return false;
+                if (buffer.size() - offset - 4 >= length) {
+                    status = static_cast<std::uint8_t>(buffer[offset + 5]);
+                    offset += 4 + length;
+                    if (offset == buffer.size()) {
+                        buffer.clear();
+                        offset = 0;
+                    }
+                    return true;
+                }
+            }
+            if (offset > 0) {
+                buffer.erase(0, offset);
+                offset = 0;
+            }
+            if (!fill()) return false;
+        }
+    }
+
+    void shutdownWrite() { shutdown(fd, SHUT_WR); }
+
+    // Let reads give up after a while; readResponse then fails with timedOut() set
+    void setReceiveTimeout(std::chrono::milliseconds timeout) {
+        timeval tv{static_cast<time_t>(timeout.count() / 1000), static_cast<suseconds_t>(timeout.count() % 1000 * 1000)};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    bool timedOut() const { return lastReadTimedOut; }
+
+private:
+    int fd = -1;
+    std::string buffer;
+    std::size_t offset = 0;
+    bool lastReadTimedOut = false;
+
+    bool fill() {
+        char chunk[65536];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        lastReadTimedOut = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<std::size_t>(n));
+        return true;
+    }
+};
+
+// One connection's view of the workload: its graph and the edges it may remove
+class Workload {
+public:
+    Workload(const LoadConfig& config, unsigned id) : config(config), random{config.seed * 0x100000001B3ULL + id} {
+        for (int i = 0; i < OP_COUNT; ++i) totalWeight += config.weights[i];
+    }
+
+    // Seed edges: a random spanning tree, then random extra edges
+    std::vector<std::string> seedFrames() {
+        std::vector<int> triples;
+        int V = config.vertices;
+        for (std::size_t i = 0; i < config.edges; ++i) {
+            int u, v;
+            if (static_cast<int>(i) + 1 < V) {
+                u = static_cast<int>(i) + 1;
+                v = random.below(u);
+            } else {
+                u = random.below(V);
+                v = random.below(V);
+            }
+            triples.insert(triples.end(), {u, v, 1 + random.below(1000000)});
+            live.emplace_back(u, v);
+        }
+        std::vector<std::string> frames;
+        for (std::size_t first = 0; first < triples.size() / 3; first += SEED_BATCH) {
+            std::size_t count = std::min(SEED_BATCH, triples.size() / 3 - first);
+            std::string frame;
+            beginFrame(frame, ADD_EDGES, 4 + 12 * count);
+            putU32(frame, static_cast<std::uint32_t>(count));
+            for (std::size_t i = 3 * first; i < 3 * (first + count); ++i) {
+                putU32(frame, static_cast<std::uint32_t>(triples[i]));
+            }
+            frames.push_back(std::move(frame));
+        }
+        return frames;
+    }
+
+    // Append the next request to out and return its type
+    OpType next(std::string& out) {
+        OpType type = pick();
+        int V = std::max(config.vertices, 1);
+        switch (type) {
+            case OP_CREATE:
+                beginFrame(out, CREATE_GRAPH, 4);
+                putU32(out, static_cast<std::uint32_t>(config.vertices));
+                live.clear();
+                break;
+            case OP_ADD: {
+                int u = random.below(V), v = random.below(V);
+                beginFrame(out, ADD_EDGE, 12);
+                putU32(out, static_cast<std::uint32_t>(u));
+                putU32(out, static_cast<std::uint32_t>(v));
+                putU32(out, static_cast<std::uint32_t>(1 + random.below(1000000)));
+                live.emplace_back(u, v);
+                break;
+            }
+            case OP_REMOVE: {
+                std::pair<int, int> edge(random.below(V), random.below(V));
+                if (!live.empty()) {
+                    std::size_t i = static_cast<std::size_t>(random.below(live.size()));
+                    edge = live[i];
+                    live[i] = live.back();
+                    live.pop_back();
+                }
+                beginFrame(out, REMOVE_EDGE, 8);
+                putU32(out, static_cast<std::uint32_t>(edge.first));
+                putU32(out, static_cast<std::uint32_t>(edge.second));
+                break;
+            }
+            case OP_MST:
+                beginFrame(out, MST_WEIGHT, 0);
+                break;
+            case OP_PATH:
+            case OP_SHORTEST:
+                beginFrame(out, type == OP_PATH ? TREE_PATH : SHORTEST_PATH, 8);
+                putU32(out, static_cast<std::uint32_t>(random.below(V)));
+                putU32(out, static_cast<std::uint32_t>(random.below(V)));
+                break;
+            default:
+                beginFrame(out, MST_STATS, 0);
+                break;
+        }
+        return type;
+    }
+
+private:
+    const LoadConfig& config;
+    Random random;
+    unsigned totalWeight = 0;
+    std::vector<std::pair<int, int>> live;  // Edges this connection added and has not removed
+
+    OpType pick() {
+        unsigned roll = static_cast<unsigned>(random.below(totalWeight));
+        for (int i = 0; i < OP_COUNT; ++i) {
+            if (roll < config.weights[i]) return static_cast<OpType>(i);
+            roll -= config.weights[i];
+        }
+        return OP_MST;
+    }
+};
+
+struct ConnectionStats {
+    LatencyHistogram latency[OP_COUNT];
+    std::uint64_t errors[OP_COUNT] = {};
+    std::uint64_t unanswered = 0;  // Open loop: still outstanding at the end of the drain
+    bool failed = false;
+};
+
+struct InFlight {
+    OpType type = OP_MST;
+    Clock::time_point scheduled;
+};
+
+// Common run window, fixed before any connection starts sending
+struct Schedule {
+    Clock::time_point start, measureFrom, stop;
+};
+
+void recordResult(ConnectionStats& stats, OpType type, std::uint8_t status, Clock::time_point sent,
+                  Clock::time_point answered, const Schedule& schedule) {
+    if (sent < schedule.measureFrom) return;
+    stats.latency[type].record(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(answered - sent).count()));
+    if (status != OK) ++stats.errors[type];
+}
+
+bool setUp(Connection& connection, Workload& workload, const LoadConfig& config, unsigned id, std::string& graphName) {
+    if (!connection.open(config)) return false;
+    std::uint8_t status = OK;
+    if (config.shared && id > 0) return true;  // Connection 0 seeds the shared graph
+    std::string frame;
+    if (config.shared) {
+        beginFrame(frame, CREATE_GRAPH, 4);
+        putU32(frame, static_cast<std::uint32_t>(config.vertices));
+    } else {
+        graphName = "loadgen-" + std::to_string(getpid()) + "-" + std::to_string(id);
+        beginFrame(frame, CREATE_NAMED, 4 + graphName.size());
+        putU32(frame, static_cast<std::uint32_t>(config.vertices));
+        frame += graphName;
+    }
+    if (!connection.sendAll(frame) || !connection.readResponse(status) || status != OK) return false;
+    for (const std::string& seed : workload.seedFrames()) {
+        if (!connection.sendAll(seed) || !connection.readResponse(status) || status != OK) return false;
+    }
+    return true;
+}
+
+// Drop a connection's graph over a fresh connection, since the old one may still have
+// answers in flight
+void tearDown(const LoadConfig& config, const std::string& graphName) {
+    if (graphName.empty()) return;
+    Connection connection;
+    if (!connection.open(config)) return;
+    std::string frame;
+    beginFrame(frame, DROP_GRAPH, graphName.size());
+    frame += graphName;
+    std::uint8_t status;
+    if (connection.sendAll(frame)) connection.readResponse(status);
+}
+
+void runClosedLoop(Connection& connection, Workload& workload, ConnectionStats& stats, const Schedule& schedule) {
+    std::string frame;
+    while (Clock::now() < schedule.stop) {
+        frame.clear();
+        OpType type = workload.next(frame);
+        Clock::time_point sent = Clock::now();
+        std::uint8_t status;
+        if (!connection.sendAll(frame) || !connection.readResponse(status)) {
+            stats.failed = true;
+            return;
+        }
+        recordResult(stats, type, status, sent, Clock::now(), schedule);
+    }
+}
+
+// The sender follows the schedule on its own thread while this one collects responses
+void runOpenLoop(Connection& connection, Workload& workload, ConnectionStats& stats, const Schedule& schedule,
+                 std::chrono::nanoseconds interval, std::chrono::nanoseconds phase) {
+    SpscRing<InFlight> inFlight(1 << 16);
+    std::atomic<std::uint64_t> sent{0};
+    std::atomic<bool> senderDone{false};
+
+    std::thread sender([&]() {
+        std::string frame;
+        Clock::time_point scheduled = schedule.start + phase;
+        while (scheduled < schedule.stop) {
+            std::this_thread::sleep_until(scheduled);
+            frame.clear();
+            InFlight request{workload.next(frame), scheduled};
+            while (!inFlight.tryPush(std::move(request))) std::this_thread::yield();
+            if (!connection.sendAll(frame)) break;
+            sent.fetch_add(1, std::memory_order_release);
+            scheduled += interval;
+        }
+        senderDone.store(true, std::memory_order_release);
+    });
+
+    connection.setReceiveTimeout(std::chrono::milliseconds(100));
+    std::uint64_t received = 0;
+    while (true) {
+        bool done = senderDone.load(std::memory_order_acquire);
+        if (received == sent.load(std::memory_order_acquire)) {
+            if (done) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        std::uint8_t status;
+        if (!connection.readResponse(status)) {
+            if (connection.timedOut() && (!done || Clock::now() < schedule.stop + DRAIN_LIMIT)) continue;
+            if (connection.timedOut()) {
+                stats.unanswered = sent.load() - received;
+            } else {
+                stats.failed = true;
+            }
+            connection.shutdownWrite();
+            break;
+        }
+        InFlight request;
+        while (!inFlight.tryPop(request)) std::this_thread::yield();
+        recordResult(stats, request.type, status, request.scheduled, Clock::now(), schedule);
+        ++received;
+    }
+    sender.join();
+}
+
+std::string formatMicros(std::uint64_t nanoseconds) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1) << nanoseconds / 1000.0;
+    return text.str();
+}
+
+void printRow(const std::string& name, const LatencyHistogram& latency, std::uint64_t errors, double seconds) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(10) << latency.count()
+              << std::setw(8) << errors << std::setw(12) << std::fixed << std::setprecision(1)
+              << latency.count() / seconds << std::setw(11) << formatMicros(static_cast<std::uint64_t>(latency.mean()))
+              << std::setw(11) << formatMicros(latency.percentile(0.50)) << std::setw(11)
+              << formatMicros(latency.percentile(0.99)) << std::setw(11) << formatMicros(latency.percentile(0.999))
+              << std::setw(12) << formatMicros(latency.max()) << "\n";
+}
+
+bool parseMix(const char* text, unsigned weights[OP_COUNT]) {
+    std::fill(weights, weights + OP_COUNT, 0u);
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        std::size_t equals = item.find('=');
+        if (equals == std::string::npos) return false;
+        std::string name = item.substr(0, equals);
+        int i = 0;
+        while (i < OP_COUNT && name != OP_NAMES[i]) ++i;
+        if (i == OP_COUNT) return false;
+        weights[i] = static_cast<unsigned>(std::max(0, std::atoi(item.c_str() + equals + 1)));
+    }
+    for (int i = 0; i < OP_COUNT; ++i) {
+        if (weights[i] > 0) return true;
+    }
+    return false;
+}
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--host H] [--port P] [--connections N] [--duration S] [--warmup S]\n"
+              << "       [--rate R] [--vertices V] [--edges E] [--mix op=w,...] [--shared] [--seed S]\n"
+              << "  --port 8081 targets leader_follower_server, 8080 pipeline_server.\n"
+              << "  --rate R sends R requests/s in total (open loop); without it every connection\n"
+              << "  waits for each answer before its next request (closed loop).\n"
+              << "  Mix ops: create, add, remove, mst, path, shortest, stats\n"
+              << "  (default create=1,add=40,remove=10,mst=25,path=15,shortest=5,stats=4).\n"
+              << "  Each connection seeds its own graph of V vertices and E edges unless --shared.\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--host") == 0 && hasValue) {
+            config.host = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && hasValue) {
+            config.port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--connections") == 0 && hasValue) {
+            config.connections = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--duration") == 0 && hasValue) {
+            config.duration = std::max(0.1, std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            config.warmup = std::max(0.0, std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--rate") == 0 && hasValue) {
+            config.rate = std::max(0.0, std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--vertices") == 0 && hasValue) {
+            config.vertices = std::max(2, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--edges") == 0 && hasValue) {
+            config.edges = static_cast<std::size_t>(std::max(0.0, std::atof(argv[++i])));
+        } else if (std::strcmp(argv[i], "--mix") == 0 && hasValue) {
+            if (!parseMix(argv[++i], config.weights)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--shared") == 0) {
+            config.shared = true;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int n = config.connections;
+    std::vector<Connection> connections(n);
+    std::vector<Workload> workloads;
+    workloads.reserve(n);
+    std::vector<std::string> graphNames(n);
+    for (int i = 0; i < n; ++i) workloads.emplace_back(config, static_cast<unsigned>(i));
+    for (int i = 0; i < n; ++i) {
+        if (!setUp(connections[i], workloads[i], config, static_cast<unsigned>(i), graphNames[i])) {
+            std::cerr << "Connection " << i << " to " << config.host << ":" << config.port << " failed during setup\n";
+            return 1;
+        }
+    }
+    std::cout << n << " connections, " << (config.shared ? "one shared graph" : "one graph each") << " of "
+              << config.vertices << " vertices and " << config.edges << " edges, "
+              << (config.rate > 0 ? "open loop at " + std::to_string(static_cast<long long>(config.rate)) + " req/s"
+                                  : std::string("closed loop"))
+              << "\n";
+
+    auto toDuration = [](double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    };
+    Schedule schedule;
+    schedule.start = Clock::now() + std::chrono::milliseconds(10);
+    schedule.measureFrom = schedule.start + toDuration(config.warmup);
+    schedule.stop = schedule.measureFrom + toDuration(config.duration);
+    std::chrono::nanoseconds interval(config.rate > 0 ? static_cast<long long>(1e9 * n / config.rate) : 0);
+
+    std::vector<ConnectionStats> stats(n);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n; ++i) {
+        threads.emplace_back([&, i]() {
+            std::this_thread::sleep_until(schedule.start);
+            if (config.rate > 0) {
+                runOpenLoop(connections[i], workloads[i], stats[i], schedule, interval, interval * i / n);
+            } else {
+                runClosedLoop(connections[i], workloads[i], stats[i], schedule);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int i = 0; i < n; ++i) {
+        tearDown(config, graphNames[i]);
+    }
+
+    LatencyHistogram perType[OP_COUNT], all;
+    std::uint64_t errors[OP_COUNT] = {}, allErrors = 0;
+    int failed = 0;
+    std::uint64_t unanswered = 0;
+    for (const auto& s : stats) {
+        failed += s.failed ? 1 : 0;
+        unanswered += s.unanswered;
+        for (int t = 0; t < OP_COUNT; ++t) {
+            perType[t].merge(s.latency[t]);
+            all.merge(s.latency[t]);
+            errors[t] += s.errors[t];
+            allErrors += s.errors[t];
+        }
+    }
+
+    std::cout << std::left << std::setw(10) << "command" << std::right << std::setw(10) << "count" << std::setw(8)
+              << "errors" << std::setw(12) << "req/s" << std::setw(11) << "mean us" << std::setw(11) << "p50 us"
+              << std::setw(11) << "p99 us" << std::setw(11) << "p99.9 us" << std::setw(12) << "max us" << "\n";
+    for (int t = 0; t < OP_COUNT; ++t) {
+        if (perType[t].count() > 0) printRow(OP_NAMES[t], perType[t], errors[t], config.duration);
+    }
+    printRow("all", all, allErrors, config.duration);
+    if (unanswered > 0) {
+        std::cout << unanswered << " requests were still unanswered " << DRAIN_LIMIT.count()
+                  << " s after the last send and are not counted; the rate exceeds what the server sustains\n";
+    }
+    if (failed > 0) {
+        std::cerr << failed << " connection(s) were closed by the server before the end of the run\n";
+        return 1;
+    }
+    return 0;
+}
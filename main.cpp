@@ -1,5 +1,10 @@
 #include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
 #include "graph.hpp"
+#include "edge_loader.hpp"
 #include "prim.hpp"
 #include "kruskal.hpp"
 #include "mst_factory.hpp"
@@ -15,11 +20,11 @@ void printMSTEdges(const std::vector<std::tuple<int, int, int>>& mstEdges) {
     std::cout << "----------------------\n";
 }
 
-// Function to print additional MST statistics
+// Function to print additional MST statistics, taken from the graph's maintained MST
 void printMSTResults(Graph& graph) {
     std::cout << "Total weight of MST: " << graph.getTotalWeight() << "\n";
     std::cout << "Longest distance in MST: " << graph.getLongestDistance() << "\n";
-    std::cout << "Average distance between edges: " << graph.getAverageDistance() << "\n";
+    std::cout << "Average distance between vertices: " << graph.getAverageDistance() << "\n";
     std::cout << "Shortest distance in MST: " << graph.getShortestDistance() << "\n";
     std::cout << "----------------------\n";
 }
@@ -34,22 +39,138 @@ void runMSTAlgorithms(Graph& graph, const std::vector<std::string>& algorithms)
         // Print the edges for the current MST
         printMSTEdges(mstEdges);
 
-        // Clear MST edges in the graph to avoid adding up from previous runs
-        graph.mstEdges.clear();
-        
-        // Add the computed MST edges to the graph for further calculations
-        for (const auto& edge : mstEdges) {
-            int weight, u, v;
-            std::tie(weight, u, v) = edge;
-            graph.addMSTEdge(u, v, weight);
-        }
-
         // Print the results for the selected algorithm
         printMSTResults(graph);
     }
 }
 
-int main() {
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void printTiming(const std::string& algorithm, const std::vector<std::tuple<int, int, int>>& mstEdges,
+                        std::chrono::steady_clock::time_point start) {
+    long long weight = 0;
+    for (const auto& edge : mstEdges) weight += std::get<0>(edge);
+    std::cout << algorithm << ": " << mstEdges.size() << " edges, total weight " << weight << " in "
+              << secondsSince(start) << " s\n";
+}
+
+// Load an edge-list file and time each algorithm on it; edge lists are too long to print.
+// external-kruskal streams the file itself under the memory budget instead of using the
+// loaded graph, so when it is the only algorithm the file is never loaded whole.
+int runOnFile(const std::string& path, int vertices, const MSTOptions& options,
+              const std::vector<std::string>& algorithms, const std::string& convertTo, bool forest) {
+    std::vector<std::string> inMemory;
+    for (const std::string& algorithm : algorithms) {
+        if (algorithm != "external-kruskal") {
+            inMemory.push_back(algorithm);
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        EdgeLoader::LoadResult load;
+        auto mstEdges = MSTFactory::computeMSTFromFile(path, algorithm, options, load);
+        if (!load.ok) {
+            std::cerr << EdgeLoader::describe(load, path) << "\n";
+            return 1;
+        }
+        printTiming(algorithm, mstEdges, start);
+    }
+    if (inMemory.empty() && convertTo.empty()) return 0;
+
+    const unsigned numThreads = options.numThreads;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> triples;
+    EdgeLoader::LoadResult result = EdgeLoader::parseFile(path, triples, EdgeLoader::AUTO, numThreads);
+    if (!result.ok) {
+        std::cerr << EdgeLoader::describe(result, path) << "\n";
+        return 1;
+    }
+    if (vertices > 0) result.vertices = vertices;
+    double parseSeconds = secondsSince(start);
+
+    if (!convertTo.empty()) {
+        if (!EdgeLoader::writeBinary(convertTo, triples, result.vertices)) {
+            std::cerr << "Failed to write '" << convertTo << "'\n";
+            return 1;
+        }
+        std::cout << "Wrote binary edge list to '" << convertTo << "'\n";
+    }
+
+    Graph graph(result.vertices);
+    graph.addEdges(triples.data(), triples.size() / 3);
+    std::vector<int>().swap(triples);
+    std::cout << EdgeLoader::describe(result, path) << " in " << secondsSince(start) << " s (parse "
+              << parseSeconds << " s)\n";
+
+    for (const std::string& algorithm : inMemory) {
+        auto algorithmStart = std::chrono::steady_clock::now();
+        if (!forest) {
+            printTiming(algorithm, MSTFactory::computeMST(graph, algorithm, options), algorithmStart);
+            continue;
+        }
+        SpanningForest result = MSTFactory::computeForest(graph, algorithm, options);
+        int largest = 0;
+        for (const auto& tree : result.trees) largest = std::max(largest, tree.vertices);
+        std::cout << algorithm << " forest: " << result.trees.size() << " trees (largest " << largest
+                  << " vertices), " << result.edgeCount() << " edges, total weight " << result.totalWeight() << " in "
+                  << secondsSince(algorithmStart) << " s\n";
+    }
+    std::cout << "----------------------\n";
+    printMSTResults(graph);
+    return 0;
+}
+
+static void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--load FILE [--vertices N] [--threads N] [--algorithms a,b,...]"
+              << " [--convert OUT] [--memory-budget MB] [--temp-dir DIR] [--forest]]\n"
+              << "  Without --load, runs the built-in examples.\n"
+              << "  FILE holds \"u v weight\" lines or the packed binary edge format; --convert writes\n"
+              << "  the loaded edges to OUT in the binary format for faster loads later.\n"
+              << "  The external-kruskal algorithm handles files larger than memory: it sorts runs of\n"
+              << "  at most --memory-budget MB of edges (default 256) into DIR (default $TMPDIR or /tmp)\n"
+              << "  and merges them, without loading the graph.\n"
+              << "  --forest solves every connected component separately and in parallel, and reports\n"
+              << "  the minimum spanning forest.\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string loadPath, convertTo;
+    bool forest = false;
+    int vertices = 0;
+    MSTOptions options;
+    options.verbose = false;
+    std::vector<std::string> fileAlgorithms = {"kruskal", "filter-kruskal", "boruvka-parallel", "prim"};
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--load") == 0 && hasValue) {
+            loadPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--vertices") == 0 && hasValue) {
+            vertices = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.numThreads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--convert") == 0 && hasValue) {
+            convertTo = argv[++i];
+        } else if (std::strcmp(argv[i], "--forest") == 0) {
+            forest = true;
+        } else if (std::strcmp(argv[i], "--memory-budget") == 0 && hasValue) {
+            options.memoryBudget = static_cast<std::size_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        } else if (std::strcmp(argv[i], "--temp-dir") == 0 && hasValue) {
+            options.tempDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--algorithms") == 0 && hasValue) {
+            fileAlgorithms.clear();
+            std::stringstream list(argv[++i]);
+            std::string name;
+            while (std::getline(list, name, ',')) {
+                if (!name.empty()) fileAlgorithms.push_back(name);
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!loadPath.empty()) return runOnFile(loadPath, vertices, options, fileAlgorithms, convertTo, forest);
+
     // Example 1: Basic Test with 5 Vertices
     Graph graph1(5);
     graph1.addEdge(0, 1, 10);
@@ -58,7 +179,7 @@ int main() {
     graph1.addEdge(1, 3, 15);
     graph1.addEdge(2, 3, 4);
 
-    std::vector<std::string> algorithms = {"prim", "kruskal"};
+    std::vector<std::string> algorithms = {"prim", "prim-dense", "kruskal", "filter-kruskal", "boruvka", "boruvka-parallel"};
     std::cout << "Example 1: Basic Test\n";
     runMSTAlgorithms(graph1, algorithms);
 
@@ -0,0 +1,59 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile {
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // False if the file cannot be opened or mapped; an empty file maps to size() == 0
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0;
+        if (ok && !S_ISREG(info.st_mode)) {
+            errno = EINVAL;
+            ok = false;
+        }
+        if (ok && info.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ok = false;
+            } else {
+                base = static_cast<const char*>(mapped);
+                length = static_cast<std::size_t>(info.st_size);
+                madvise(mapped, length, MADV_WILLNEED);  // Start readahead for the whole file
+            }
+        }
+        ::close(fd);  // The mapping stays valid without the descriptor
+        return ok;
+    }
+
+    void close() {
+        if (base != nullptr) munmap(const_cast<char*>(base), length);
+        base = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return base; }
+    std::size_t size() const { return length; }
+
+private:
+    const char* base = nullptr;
+    std::size_t length = 0;
+};
+
+#endif  // MAPPED_FILE_HPP
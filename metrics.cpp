@@ -0,0 +1,222 @@
+#include "metrics.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "latency_histogram.hpp"
+
+namespace Metrics {
+
+namespace {
+
+// A histogram written by one thread only; readers may load it at any time
+struct ThreadHistogram {
+    std::atomic<std::uint64_t> counts[LatencyHistogram::BUCKETS];
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> maximum{0};
+
+    ThreadHistogram() {
+        for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Single-writer increment: the owner is the only thread that stores, so no RMW is needed
+inline void bump(std::atomic<std::uint64_t>& cell, std::uint64_t amount) {
+    cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+struct Shard {
+    std::atomic<std::uint64_t> counters[MAX_COUNTERS];
+    std::atomic<ThreadHistogram*> histograms[MAX_HISTOGRAMS];
+
+    Shard() {
+        for (auto& counter : counters) counter.store(0, std::memory_order_relaxed);
+        for (auto& histogram : histograms) histogram.store(nullptr, std::memory_order_relaxed);
+    }
+    ~Shard() {
+        for (auto& histogram : histograms) delete histogram.load(std::memory_order_relaxed);
+    }
+};
+
+struct Gauge {
+    std::string name;
+    std::function<long long()> sample;
+};
+
+// Shards outlive their threads so that nothing recorded is lost
+struct Registry {
+    std::mutex mtx;
+    std::vector<std::string> counterNames;
+    std::vector<std::string> histogramNames;
+    std::vector<Unit> histogramUnits;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::map<int, Gauge> gauges;
+    int nextGauge = 0;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();  // Never destroyed: threads may record during exit
+    return *instance;
+}
+
+Shard& localShard() {
+    thread_local Shard* shard = nullptr;
+    if (shard == nullptr) {
+        std::unique_ptr<Shard> fresh(new Shard());
+        shard = fresh.get();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        r.shards.push_back(std::move(fresh));
+    }
+    return *shard;
+}
+
+int lookup(std::vector<std::string>& names, const std::string& name, int limit) {
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return static_cast<int>(i);
+    }
+    if (static_cast<int>(names.size()) >= limit) return -1;
+    names.push_back(name);
+    return static_cast<int>(names.size()) - 1;
+}
+
+std::string formatValue(std::uint64_t value, Unit unit) {
+    if (unit == COUNT) return std::to_string(value);
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1fus", value / 1000.0);
+    return text;
+}
+
+}  // namespace
+
+int counter(const std::string& name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    return lookup(r.counterNames, name, MAX_COUNTERS);
+}
+
+int histogram(const std::string& name, Unit unit) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    int id = lookup(r.histogramNames, name, MAX_HISTOGRAMS);
+    if (id >= static_cast<int>(r.histogramUnits.size())) r.histogramUnits.push_back(unit);
+    return id;
+}
+
+void add(int counter, std::uint64_t amount) {
+    if (counter < 0) return;
+    bump(localShard().counters[counter], amount);
+}
+
+void record(int histogram, std::uint64_t value) {
+    if (histogram < 0) return;
+    Shard& shard = localShard();
+    ThreadHistogram* h = shard.histograms[histogram].load(std::memory_order_relaxed);
+    if (h == nullptr) {
+        h = new ThreadHistogram();
+        shard.histograms[histogram].store(h, std::memory_order_release);
+    }
+    bump(h->counts[LatencyHistogram::bucketOf(value)], 1);
+    bump(h->sum, value);
+    if (value > h->maximum.load(std::memory_order_relaxed)) h->maximum.store(value, std::memory_order_relaxed);
+}
+
+int gauge(const std::string& name, std::function<long long()> sample) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    int id = r.nextGauge++;
+    r.gauges[id] = Gauge{name, std::move(sample)};
+    return id;
+}
+
+void removeGauge(int id) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    r.gauges.erase(id);
+}
+
+std::string report() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    std::string out;
+
+    for (std::size_t id = 0; id < r.counterNames.size(); ++id) {
+        std::uint64_t total = 0;
+        for (const auto& shard : r.shards) total += shard->counters[id].load(std::memory_order_relaxed);
+        out += r.counterNames[id] + " " + std::to_string(total) + "\n";
+    }
+
+    std::vector<std::uint64_t> counts(LatencyHistogram::BUCKETS);
+    for (std::size_t id = 0; id < r.histogramNames.size(); ++id) {
+        LatencyHistogram merged;
+        for (const auto& shard : r.shards) {
+            const ThreadHistogram* h = shard->histograms[id].load(std::memory_order_acquire);
+            if (h == nullptr) continue;
+            for (std::size_t b = 0; b < counts.size(); ++b) counts[b] = h->counts[b].load(std::memory_order_relaxed);
+            merged.addCounts(counts.data(), h->sum.load(std::memory_order_relaxed),
+                             h->maximum.load(std::memory_order_relaxed));
+        }
+        if (merged.count() == 0) continue;
+        Unit unit = r.histogramUnits[id];
+        char mean[32];
+        std::snprintf(mean, sizeof(mean), unit == COUNT ? "%.1f" : "%.1fus",
+                      unit == COUNT ? merged.mean() : merged.mean() / 1000.0);
+        out += r.histogramNames[id] + " count=" + std::to_string(merged.count()) + " mean=" + mean +
+               " p50=" + formatValue(merged.percentile(0.50), unit) +
+               " p99=" + formatValue(merged.percentile(0.99), unit) +
+               " p999=" + formatValue(merged.percentile(0.999), unit) +
+               " max=" + formatValue(merged.max(), unit) + "\n";
+    }
+
+    for (const auto& entry : r.gauges) {
+        out += entry.second.name + " " + std::to_string(entry.second.sample()) + "\n";
+    }
+    return out;
+}
+
+bool startEndpoint(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Local only
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(fd, 16) < 0) {
+        close(fd);
+        return false;
+    }
+
+    std::thread([fd]() {
+        while (true) {
+            int client = accept(fd, nullptr, nullptr);
+            if (client < 0) continue;
+            // Take whatever request the client sends first so closing does not reset it
+            timeval timeout{0, 100000};
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            char request[1024];
+            recv(client, request, sizeof(request), 0);
+            std::string body = report();
+            std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\nContent-Length: " +
+                                   std::to_string(body.size()) + "\r\n\r\n" + body;
+            std::size_t sent = 0;
+            while (sent < response.size()) {
+                ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                sent += static_cast<std::size_t>(n);
+            }
+            close(client);
+        }
+    }).detach();
+    return true;
+}
+
+}  // namespace Metrics
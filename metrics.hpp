@@ -0,0 +1,68 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Process-wide instrumentation for the servers.
+// Counters and histograms are registered by name once and then addressed by id. Every thread
+// records into its own shard with plain relaxed loads and stores (no lock, no shared cache
+// line, no read-modify-write); report() sums the shards while they keep running, so a
+// reading may be a few events behind. Histograms use LatencyHistogram's log-linear buckets
+// and are allocated the first time a thread records into them. Gauges are callbacks sampled
+// at report time, for values that already live somewhere (queue depths, connection counts).
+namespace Metrics {
+
+enum Unit { NANOSECONDS, COUNT };
+
+const int MAX_COUNTERS = 256;
+const int MAX_HISTOGRAMS = 256;
+
+// Look up or register a metric; ids stay valid for the life of the process. Returns -1 once
+// the table is full, which the recording functions ignore.
+int counter(const std::string& name);
+int histogram(const std::string& name, Unit unit = NANOSECONDS);
+
+void add(int counter, std::uint64_t amount = 1);
+void record(int histogram, std::uint64_t value);
+
+// Gauges may be removed again, e.g. by an object that is going away
+int gauge(const std::string& name, std::function<long long()> sample);
+void removeGauge(int id);
+
+// Every metric as "name value" lines, histograms with count, mean and percentiles
+// (nanosecond histograms in microseconds)
+std::string report();
+
+// Serve report() to every connection on 127.0.0.1:port, as a plain HTTP/1.0 response so
+// both curl and nc can read it; false if the port cannot be bound
+bool startEndpoint(int port);
+
+inline std::uint64_t nanosSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+// Record the lifetime of a scope into a nanosecond histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(int histogram) : id(histogram), start(std::chrono::steady_clock::now()) {}
+    // Measure from an earlier moment, e.g. when a request entered a queue
+    ScopedTimer(int histogram, std::chrono::steady_clock::time_point since) : id(histogram), start(since) {}
+    ~ScopedTimer() { record(id, nanosSince(start)); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    int id;
+    std::chrono::steady_clock::time_point start;
+};
+
+}  // namespace Metrics
+
+#endif  // METRICS_HPP
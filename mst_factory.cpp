@@ -1,15 +1,130 @@
 #include "mst_factory.hpp"
+#include "parallel.hpp"
+#include "work_stealing_pool.hpp"
 using namespace std;
-std::vector<std::tuple<int, int, int>> MSTFactory::computeMST(Graph& graph, const std::string& algorithm) {
-    // if (algorithm == "boruvka") {
-    //     BoruvkaMST boruvka;
-    //     return boruvka.computeMST(graph);
-      if (algorithm == "prim") {
-        PrimMST prim;
+std::vector<std::tuple<int, int, int>> MSTFactory::computeMST(const Graph& graph, const std::string& algorithm,
+                                                              const MSTOptions& options) {
+    if (algorithm == "boruvka") {
+        BoruvkaMST boruvka(1, options.verbose, options.cancel);
+        return boruvka.computeMST(graph);
+    } else if (algorithm == "boruvka-parallel") {
+        BoruvkaMST boruvka(resolveThreadCount(options.numThreads), options.verbose, options.cancel);
+        return boruvka.computeMST(graph);
+    } else if (algorithm == "prim") {
+        PrimMST prim(options.verbose, options.cancel);
         return prim.computeMST(graph);
+    } else if (algorithm == "prim-dense") {
+        PrimMST prim(options.verbose, options.cancel);
+        return prim.computeDenseMST(graph);
     } else if (algorithm == "kruskal") {
-        KruskalMST kruskal;
+        KruskalMST kruskal(resolveThreadCount(options.numThreads), options.verbose, options.cancel);
         return kruskal.computeMST(graph);
+    } else if (algorithm == "filter-kruskal") {
+        KruskalMST kruskal(1, options.verbose, options.cancel);
+        return kruskal.computeFilterMST(graph);
     }
     return {};
 }
+
+std::vector<std::tuple<int, int, int>> MSTFactory::computeMSTFromFile(const std::string& path,
+                                                                      const std::string& algorithm,
+                                                                      const MSTOptions& options,
+                                                                      EdgeLoader::LoadResult& load) {
+    if (algorithm == "external-kruskal") {
+        ExternalKruskalMST kruskal(options.memoryBudget, options.tempDir, options.verbose, options.cancel);
+        return kruskal.computeMST(path, load);
+    }
+    Graph graph(0);
+    load = EdgeLoader::loadGraph(path, graph, 0, EdgeLoader::AUTO, options.numThreads);
+    if (!load.ok) return {};
+    return computeMST(graph, algorithm, options);
+}
+
+SpanningForest MSTFactory::computeForest(const Graph& graph, const std::string& algorithm,
+                                        const MSTOptions& options) {
+    SpanningForest forest;
+    const int V = graph.V;
+    const int count = connectedComponents(graph, forest.component, options.numThreads, options.cancel);
+    if (V > 0 && count == 0) return forest;  // Cancelled
+
+    // Group vertices and edges by component: members lists each component's vertices in
+    // order, local maps a vertex to its index there, and the edges become local triples
+    std::vector<std::size_t> vertexStart(count + 1, 0), edgeStart(count + 1, 0);
+    for (int v = 0; v < V; ++v) ++vertexStart[forest.component[v] + 1];
+    const auto& edges = graph.getEdges();
+    for (const auto& edge : edges) ++edgeStart[forest.component[std::get<1>(edge)] + 1];
+    for (int c = 0; c < count; ++c) {
+        vertexStart[c + 1] += vertexStart[c];
+        edgeStart[c + 1] += edgeStart[c];
+    }
+    std::vector<int> members(V), local(V);
+    std::vector<std::size_t> fill(vertexStart.begin(), vertexStart.end() - 1);
+    for (int v = 0; v < V; ++v) {
+        std::size_t slot = fill[forest.component[v]]++;
+        members[slot] = v;
+        local[v] = static_cast<int>(slot - vertexStart[forest.component[v]]);
+    }
+    std::vector<int> triples(3 * edges.size());
+    fill.assign(edgeStart.begin(), edgeStart.end() - 1);
+    for (const auto& edge : edges) {
+        int weight, u, v;
+        std::tie(weight, u, v) = edge;
+        std::size_t slot = fill[forest.component[u]]++;
+        triples[3 * slot] = local[u];
+        triples[3 * slot + 1] = local[v];
+        triples[3 * slot + 2] = weight;
+    }
+
+    forest.trees.resize(count);
+    MSTOptions islandOptions = options;
+    islandOptions.verbose = false;
+    struct Island {
+        const std::string& algorithm;
+        const MSTOptions& options;
+        const std::vector<std::size_t>& vertexStart;
+        const std::vector<std::size_t>& edgeStart;
+        const std::vector<int>& members;
+        const std::vector<int>& triples;
+        std::vector<ComponentTree>& trees;
+
+        void solve(int c) const {
+            ComponentTree& tree = trees[c];
+            const int* vertex = &members[vertexStart[c]];
+            tree.root = vertex[0];
+            tree.vertices = static_cast<int>(vertexStart[c + 1] - vertexStart[c]);
+            if (edgeStart[c + 1] == edgeStart[c] || CancelToken::check(options.cancel)) return;
+            Graph island(tree.vertices);
+            island.addEdges(&triples[3 * edgeStart[c]], edgeStart[c + 1] - edgeStart[c]);
+            tree.edges = MSTFactory::computeMST(island, algorithm, options);
+            if (CancelToken::check(options.cancel)) return;
+            tree.stats = computeMSTStats(tree.vertices, tree.edges);  // Still in local ids
+            for (auto& edge : tree.edges) {
+                std::get<1>(edge) = vertex[std::get<1>(edge)];
+                std::get<2>(edge) = vertex[std::get<2>(edge)];
+            }
+        }
+    };
+    const Island islands{algorithm, islandOptions, vertexStart, edgeStart, members, triples, forest.trees};
+    // Islands go to the pool in batches of at least PARALLEL_GRAIN vertices and edges, so
+    // thousands of tiny ones do not each pay for a task
+    TaskGroup group;
+    int first = 0;
+    std::size_t batch = 0;
+    for (int c = 0; c < count; ++c) {
+        batch += (vertexStart[c + 1] - vertexStart[c]) + (edgeStart[c + 1] - edgeStart[c]);
+        if (batch < PARALLEL_GRAIN && c + 1 < count) continue;
+        const Island* shared = &islands;
+        group.run([shared, first, c]() {
+            for (int i = first; i <= c; ++i) shared->solve(i);
+        });
+        first = c + 1;
+        batch = 0;
+    }
+    group.wait();
+    return forest;
+}
+
+bool MSTFactory::isKnown(const std::string& algorithm) {
+    return algorithm == "boruvka" || algorithm == "boruvka-parallel" || algorithm == "prim" ||
+           algorithm == "prim-dense" || algorithm == "kruskal" || algorithm == "filter-kruskal";
+}
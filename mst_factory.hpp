@@ -8,10 +8,43 @@
 #include "Boruvka.hpp"
 #include "prim.hpp"
 #include "kruskal.hpp"
+#include "cancel_token.hpp"
+#include "edge_loader.hpp"
+#include "external_kruskal.hpp"
+#include "spanning_forest.hpp"
+
+// Tuning knobs shared by the MST algorithms
+struct MSTOptions {
+    unsigned numThreads = 0;  // Worker threads for parallel algorithms, 0 = all hardware threads
+    bool verbose = true;      // Let the algorithm print the edges it selects
+    const CancelToken* cancel = nullptr;  // Stops the run early; its partial result is meaningless
+    std::size_t memoryBudget = 0;  // external-kruskal: bytes of edges held in memory, 0 = its default
+    std::string tempDir;           // external-kruskal: where sorted runs spill, empty = $TMPDIR or /tmp
+};
 
 class MSTFactory {
 public:
-    static std::vector<std::tuple<int, int, int>> computeMST(Graph& graph, const std::string& algorithm);
+    // Unknown algorithm names yield an empty tree
+    static std::vector<std::tuple<int, int, int>> computeMST(const Graph& graph, const std::string& algorithm,
+                                                             const MSTOptions& options = MSTOptions());
+
+    static bool isKnown(const std::string& algorithm);
+
+    // Minimum spanning forest with a tree and its stats per connected component. Components
+    // are found in parallel, and every component with edges becomes its own subgraph whose
+    // MST and computeMSTStats are computed by algorithm as a separate task on the shared pool,
+    // so thousands of islands are solved concurrently. Trees are never printed, whatever
+    // options.verbose says.
+    static SpanningForest computeForest(const Graph& graph, const std::string& algorithm,
+                                        const MSTOptions& options = MSTOptions());
+
+    // MST of an edge-list file. "external-kruskal" streams the file through options.memoryBudget
+    // and never holds the whole edge set; any other algorithm loads the graph first. load
+    // describes the file, and the tree is empty when it could not be read.
+    static std::vector<std::tuple<int, int, int>> computeMSTFromFile(const std::string& path,
+                                                                     const std::string& algorithm,
+                                                                     const MSTOptions& options,
+                                                                     EdgeLoader::LoadResult& load);
 };
 
 #endif  // MST_FACTORY_HPP
@@ -0,0 +1,87 @@
+#include "mst_stats.hpp"
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include "simd_kernels.hpp"
+
+MSTStats computeMSTStats(int V, const std::vector<std::tuple<int, int, int>>& treeEdges) {
+    MSTStats stats;
+    stats.edgeCount = treeEdges.size();
+    if (V == 0 || treeEdges.empty()) return stats;
+
+    // Degrees for the tree adjacency in CSR form; the weights are copied out contiguously for
+    // the vectorized sum/min/max
+    std::vector<int> offsets(V + 1, 0), weights(treeEdges.size());
+    for (std::size_t i = 0; i < treeEdges.size(); ++i) {
+        weights[i] = std::get<0>(treeEdges[i]);
+        ++offsets[std::get<1>(treeEdges[i]) + 1];
+        ++offsets[std::get<2>(treeEdges[i]) + 1];
+    }
+    Simd::WeightSummary summary = Simd::summarize(weights.data(), weights.size());
+    stats.totalWeight = summary.sum;
+    stats.heaviestEdge = summary.max;
+    stats.lightestEdge = summary.min;
+
+    for (int x = 0; x < V; ++x) offsets[x + 1] += offsets[x];
+    std::vector<std::pair<int, int>> adj(offsets[V]);
+    std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto& edge : treeEdges) {
+        int weight, u, v;
+        std::tie(weight, u, v) = edge;
+        adj[cursor[u]++] = {v, weight};
+        adj[cursor[v]++] = {u, weight};
+    }
+
+    std::vector<int> parent(V, -1), parentWeight(V, 0);
+    std::vector<char> visited(V, 0);
+    // down/low: longest and shortest path from a vertex down into its subtree, the empty
+    // path included; a candidate path always crosses an edge, so it joins distinct vertices
+    std::vector<long long> size(V, 1), down(V, 0), low(V, 0);
+    stats.diameter = LLONG_MIN;
+    stats.shortestDistance = LLONG_MAX;
+    std::vector<int> order;
+    order.reserve(V);
+    long double distanceSum = 0;
+
+    for (int root = 0; root < V; ++root) {
+        if (visited[root] || offsets[root] == offsets[root + 1]) continue;
+
+        // BFS order of this tree; processing it backwards visits children before parents
+        std::size_t first = order.size();
+        visited[root] = 1;
+        order.push_back(root);
+        for (std::size_t i = first; i < order.size(); ++i) {
+            int x = order[i];
+            for (int k = offsets[x]; k < offsets[x + 1]; ++k) {
+                int y = adj[k].first;
+                if (visited[y]) continue;
+                visited[y] = 1;
+                parent[y] = x;
+                parentWeight[y] = adj[k].second;
+                order.push_back(y);
+            }
+        }
+        const long long treeSize = static_cast<long long>(order.size() - first);
+        stats.pairCount += static_cast<unsigned long long>(treeSize) * (treeSize - 1) / 2;
+
+        for (std::size_t i = order.size(); i-- > first + 1;) {
+            int y = order[i];
+            int x = parent[y];
+            long long w = parentWeight[y];
+
+            // Every pair split by edge (x, y) crosses it once
+            distanceSum += static_cast<long double>(w) * size[y] * (treeSize - size[y]);
+            size[x] += size[y];
+
+            long long through = down[y] + w;
+            stats.diameter = std::max(stats.diameter, down[x] + through);
+            down[x] = std::max(down[x], through);
+            long long lowThrough = low[y] + w;
+            stats.shortestDistance = std::min(stats.shortestDistance, low[x] + lowThrough);
+            low[x] = std::min(low[x], lowThrough);
+        }
+    }
+
+    if (stats.pairCount > 0) stats.averageDistance = static_cast<double>(distanceSum / stats.pairCount);
+    return stats;
+}
@@ -0,0 +1,26 @@
+#ifndef MST_STATS_HPP
+#define MST_STATS_HPP
+
+#include <vector>
+#include <tuple>
+#include <cstddef>
+
+// Whole-tree statistics of a spanning forest. Distances are path lengths between vertices
+// of the same tree; pairs in different trees are not counted. Nothing is clamped: with
+// negative edges the shortest distance (and even the diameter) can be negative.
+struct MSTStats {
+    std::size_t edgeCount = 0;
+    long long totalWeight = 0;
+    int heaviestEdge = 0;
+    int lightestEdge = 0;
+    long long diameter = 0;          // Longest distance between two vertices
+    long long shortestDistance = 0;  // Shortest distance between two distinct vertices
+    double averageDistance = 0;      // Mean distance over all connected vertex pairs
+    unsigned long long pairCount = 0;
+};
+
+// Single iterative traversal, O(V): the diameter comes from the two longest downward paths
+// at every vertex and the all-pairs mean from each edge's w * size * (treeSize - size).
+MSTStats computeMSTStats(int V, const std::vector<std::tuple<int, int, int>>& treeEdges);
+
+#endif  // MST_STATS_HPP
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "dsu.hpp"
+#include "graph.hpp"
+#include "mst_factory.hpp"
+#include "mst_stats.hpp"
+#include "shortest_path.hpp"
+
+// MST test suite: cross-checks every MSTFactory algorithm and the spanning forest against
+// Kruskal, the incrementally maintained MST against a full recompute after random updates,
+// and the Dial and radix-heap searches against a plain binary-heap Dijkstra. Graphs are
+// seeded and random: disconnected, with isolated vertices, parallel edges, self-loops and
+// many duplicate weights. Built and run by `make test`; exits non-zero on any mismatch.
+
+namespace {
+
+const std::vector<std::string> ALGORITHMS = {"prim", "prim-dense", "kruskal", "filter-kruskal", "boruvka",
+                                             "boruvka-parallel"};
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (ok) return;
+    ++failures;
+    std::cerr << "FAIL: " << what << "\n";
+}
+
+struct Case {
+    int vertices;
+    int edges;
+    int maxWeight;  // Small maxima give many duplicate weights
+    int islands;    // Edges stay inside one of this many vertex groups
+};
+
+// Random edges inside `islands` groups of consecutive vertices; the last vertex of every
+// group takes no edges, so isolated vertices always exist
+void addRandomEdges(Graph& graph, std::mt19937& rng, const Case& test, int minWeight = 1) {
+    std::uniform_int_distribution<int> island(0, test.islands - 1);
+    std::uniform_int_distribution<int> weight(minWeight, test.maxWeight);
+    const int size = test.vertices / test.islands;
+    for (int i = 0; i < test.edges; ++i) {
+        int base = island(rng) * size;
+        std::uniform_int_distribution<int> member(base, base + std::max(size - 2, 0));
+        graph.addEdge(member(rng), member(rng), weight(rng));
+    }
+}
+
+long long totalWeight(const std::vector<std::tuple<int, int, int>>& tree) {
+    long long total = 0;
+    for (const auto& edge : tree) total += std::get<0>(edge);
+    return total;
+}
+
+// Connected components of the graph, counted with a sequential DSU
+int componentCount(const Graph& graph) {
+    DSU dsu(graph.V);
+    int count = graph.V;
+    for (const auto& edge : graph.getEdges()) {
+        int a = dsu.find(std::get<1>(edge)), b = dsu.find(std::get<2>(edge));
+        if (a != b) {
+            dsu.unite(a, b);
+            --count;
+        }
+    }
+    return count;
+}
+
+// A spanning forest of the graph: acyclic, with V - components edges
+bool isSpanningForest(const Graph& graph, const std::vector<std::tuple<int, int, int>>& tree) {
+    if (static_cast<int>(tree.size()) != graph.V - componentCount(graph)) return false;
+    DSU dsu(graph.V);
+    for (const auto& edge : tree) {
+        int u = std::get<1>(edge), v = std::get<2>(edge);
+        if (!graph.isValidVertex(u) || !graph.isValidVertex(v) || dsu.find(u) == dsu.find(v)) return false;
+        dsu.unite(u, v);
+    }
+    return true;
+}
+
+std::vector<std::tuple<int, int, int>> kruskal(const Graph& graph) {
+    MSTOptions options;
+    options.verbose = false;
+    return MSTFactory::computeMST(graph, "kruskal", options);
+}
+
+std::string describe(const Case& test, unsigned seed) {
+    std::ostringstream out;
+    out << "V=" << test.vertices << " E=" << test.edges << " maxWeight=" << test.maxWeight
+        << " islands=" << test.islands << " seed=" << seed;
+    return out.str();
+}
+
+void testAlgorithms(const Case& test, unsigned seed) {
+    std::mt19937 rng(seed);
+    Graph graph(test.vertices);
+    addRandomEdges(graph, rng, test);
+    const std::string where = describe(test, seed);
+
+    const auto reference = kruskal(graph);
+    check(isSpanningForest(graph, reference), "kruskal is not a spanning forest, " + where);
+    const long long expected = totalWeight(reference);
+
+    MSTOptions options;
+    options.verbose = false;
+    for (const auto& algorithm : ALGORITHMS) {
+        const auto tree = MSTFactory::computeMST(graph, algorithm, options);
+        check(isSpanningForest(graph, tree), algorithm + " is not a spanning forest, " + where);
+        check(totalWeight(tree) == expected, algorithm + " weight " + std::to_string(totalWeight(tree)) +
+                                                 " != kruskal " + std::to_string(expected) + ", " + where);
+
+        const SpanningForest forest = MSTFactory::computeForest(graph, algorithm, options);
+        check(forest.trees.size() == static_cast<std::size_t>(componentCount(graph)),
+              algorithm + " forest has the wrong number of trees, " + where);
+        check(isSpanningForest(graph, forest.edges()), algorithm + " forest is not a spanning forest, " + where);
+        check(forest.totalWeight() == expected, algorithm + " forest weight != kruskal, " + where);
+    }
+}
+
+// Random inserts and deletes; the maintained MST must match a recompute after every step
+void testDynamic(const Case& test, unsigned seed) {
+    std::mt19937 rng(seed);
+    Graph graph(test.vertices);
+    addRandomEdges(graph, rng, test);
+    const std::string where = describe(test, seed);
+
+    std::uniform_int_distribution<int> vertex(0, test.vertices - 1), weight(1, test.maxWeight), coin(0, 2);
+    for (int step = 0; step < 300; ++step) {
+        const auto& edges = graph.getEdges();
+        if (coin(rng) == 0 && !edges.empty()) {
+            std::uniform_int_distribution<std::size_t> pick(0, edges.size() - 1);
+            auto edge = edges[pick(rng)];
+            graph.removeEdge(std::get<1>(edge), std::get<2>(edge));
+        } else {
+            graph.addEdge(vertex(rng), vertex(rng), weight(rng));
+        }
+
+        const auto& maintained = graph.getMST();
+        const long long expected = totalWeight(kruskal(graph));
+        bool ok = isSpanningForest(graph, maintained) && totalWeight(maintained) == expected &&
+                  graph.getMSTStats().totalWeight == expected;
+        check(ok, "maintained MST differs from a recompute after step " + std::to_string(step) + ", " + where);
+        if (!ok) return;
+    }
+}
+
+// Binary-heap Dijkstra over the edge list; NEGATIVE_CYCLE when start's component has a
+// negative edge, as ShortestPath documents
+long long baselineDistance(const Graph& graph, int start, int end) {
+    std::vector<std::vector<std::pair<int, int>>> adjacency(graph.V);
+    DSU dsu(graph.V);
+    for (const auto& edge : graph.getEdges()) {
+        int weight, u, v;
+        std::tie(weight, u, v) = edge;
+        adjacency[u].push_back({v, weight});
+        adjacency[v].push_back({u, weight});
+        dsu.unite(u, v);
+    }
+    for (const auto& edge : graph.getEdges()) {
+        if (std::get<0>(edge) < 0 && dsu.find(std::get<1>(edge)) == dsu.find(start)) {
+            return ShortestPath::NEGATIVE_CYCLE;
+        }
+    }
+
+    std::vector<long long> dist(graph.V, -1);
+    std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>, std::greater<>> pq;
+    dist[start] = 0;
+    pq.push({0, start});
+    while (!pq.empty()) {
+        auto top = pq.top();
+        pq.pop();
+        if (top.first != dist[top.second]) continue;
+        for (const auto& next : adjacency[top.second]) {
+            long long candidate = top.first + next.second;
+            if (dist[next.first] < 0 || candidate < dist[next.first]) {
+                dist[next.first] = candidate;
+                pq.push({candidate, next.first});
+            }
+        }
+    }
+    return dist[end];
+}
+
+// minWeight 0 allows zero-weight edges; a negative one exercises the negative-edge guard
+void testShortestPaths(const Case& test, unsigned seed, int minWeight) {
+    std::mt19937 rng(seed);
+    Graph graph(test.vertices);
+    addRandomEdges(graph, rng, test, minWeight);
+    const std::string where = describe(test, seed) + " minWeight=" + std::to_string(minWeight);
+
+    std::uniform_int_distribution<int> vertex(0, test.vertices - 1);
+    for (int query = 0; query < 50; ++query) {
+        int start = vertex(rng), end = vertex(rng);
+        long long expected = baselineDistance(graph, start, end);
+        long long single = ShortestPath::distance(graph, start, end);
+        long long both = ShortestPath::bidirectionalDistance(graph, start, end);
+        std::string pair = " " + std::to_string(start) + "->" + std::to_string(end) + " expected " +
+                           std::to_string(expected) + ", ";
+        check(single == expected, "distance " + std::to_string(single) + pair + where);
+        check(both == expected, "bidirectional distance " + std::to_string(both) + pair + where);
+    }
+}
+
+// Diameter and shortest distance of a forest against every pair's path length, on trees
+// with weights of both signs
+void testStats(unsigned seed) {
+    std::mt19937 rng(seed);
+    Graph graph(60);
+    addRandomEdges(graph, rng, {60, 150, 6, 3}, -6);
+    const auto tree = kruskal(graph);
+    const MSTStats stats = computeMSTStats(graph.V, tree);
+
+    std::vector<std::vector<std::pair<int, int>>> adjacency(graph.V);
+    for (const auto& edge : tree) {
+        adjacency[std::get<1>(edge)].push_back({std::get<2>(edge), std::get<0>(edge)});
+        adjacency[std::get<2>(edge)].push_back({std::get<1>(edge), std::get<0>(edge)});
+    }
+    bool any = false;
+    long long longest = 0, shortest = 0;
+    for (int start = 0; start < graph.V; ++start) {
+        std::vector<long long> dist(graph.V, 0);
+        std::vector<char> seen(graph.V, 0);
+        std::vector<int> stack = {start};
+        seen[start] = 1;
+        while (!stack.empty()) {
+            int x = stack.back();
+            stack.pop_back();
+            for (const auto& next : adjacency[x]) {
+                if (seen[next.first]) continue;
+                seen[next.first] = 1;
+                dist[next.first] = dist[x] + next.second;
+                stack.push_back(next.first);
+                longest = any ? std::max(longest, dist[next.first]) : dist[next.first];
+                shortest = any ? std::min(shortest, dist[next.first]) : dist[next.first];
+                any = true;
+            }
+        }
+    }
+    const std::string where = "seed=" + std::to_string(seed);
+    check(stats.diameter == longest, "diameter " + std::to_string(stats.diameter) + " != " +
+                                         std::to_string(longest) + ", " + where);
+    check(stats.shortestDistance == shortest, "shortest distance " + std::to_string(stats.shortestDistance) +
+                                                  " != " + std::to_string(shortest) + ", " + where);
+}
+
+// Heavily skewed weights (powers of two, most of them tiny) through Filter-Kruskal's
+// partitioning, which must fall back to sorting rather than recurse deeply
+void testSkewedWeights(unsigned seed) {
+    std::mt19937 rng(seed);
+    Graph graph(20000);
+    std::uniform_int_distribution<int> vertex(0, graph.V - 1);
+    std::geometric_distribution<int> exponent(0.5);
+    std::vector<int> triples;
+    for (int i = 0; i < 200000; ++i) {
+        triples.insert(triples.end(), {vertex(rng), vertex(rng), 1 << std::min(exponent(rng), 30)});
+    }
+    graph.addEdges(triples.data(), triples.size() / 3);
+    MSTOptions options;
+    options.verbose = false;
+    const auto tree = MSTFactory::computeMST(graph, "filter-kruskal", options);
+    check(totalWeight(tree) == totalWeight(kruskal(graph)), "filter-kruskal on skewed weights, seed=" +
+                                                                std::to_string(seed));
+}
+
+// The weight bounds start at the first edge and only ever widen
+void testWeightBounds() {
+    Graph positive(4);
+    check(positive.getMinEdgeWeight() == 0 && positive.getMaxEdgeWeight() == 0, "bounds of a graph without edges");
+    positive.addEdge(0, 1, 7);
+    positive.addEdge(1, 2, 3);
+    check(positive.getMinEdgeWeight() == 3 && positive.getMaxEdgeWeight() == 7, "bounds of positive weights");
+    positive.removeEdge(1, 2);
+    check(positive.getMinEdgeWeight() == 3, "bounds shrank on removal");
+
+    Graph negative(4);
+    const int triples[] = {0, 1, -4, 2, 3, -9};
+    negative.addEdges(triples, 2);
+    check(negative.getMinEdgeWeight() == -9 && negative.getMaxEdgeWeight() == -4, "bounds of negative weights");
+}
+
+}  // namespace
+
+int main() {
+    testWeightBounds();
+    for (unsigned seed = 1; seed <= 10; ++seed) testStats(seed);
+    for (unsigned seed = 1; seed <= 3; ++seed) testSkewedWeights(seed);
+    const std::vector<Case> cases = {
+        {1, 0, 1, 1},          {2, 1, 1, 1},         {50, 200, 3, 1},      {200, 600, 5, 4},
+        {500, 400, 1000, 10},  {1000, 5000, 2, 3},   {2000, 8000, 1000000, 7}, {3000, 2500, 10, 50},
+    };
+
+    for (const auto& test : cases) {
+        for (unsigned seed = 1; seed <= 3; ++seed) {
+            testAlgorithms(test, seed);
+            testDynamic(test, seed);
+            // Weights up to maxWeight pick the Dial queue or, past its limit, the radix heap
+            testShortestPaths(test, seed, 0);
+            testShortestPaths({test.vertices, test.edges, 100000, test.islands}, seed, 1);
+            testShortestPaths(test, seed, -1);
+        }
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All MST and shortest-path checks passed\n";
+    return 0;
+}
@@ -0,0 +1,107 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Slab pool of reusable objects for a hand-off between threads.
+// One owner thread acquires objects; any thread may release them. Objects are carved out of
+// slabs of SLAB_SIZE and never freed until the pool goes away, so a steady stream of
+// requests stops allocating once the pool has grown to the number in flight. Releases push
+// onto a lock-free stack that the owner takes over whole when its private free list runs
+// dry; taking the whole stack with one exchange keeps the stack free of ABA problems.
+// A released object is reset on the releasing thread by Reset, so acquire hands out fresh
+// ones. The default assigns T(), which frees whatever the object owns; types whose strings
+// or vectors are worth reusing supply a Reset that clears them and keeps their capacity.
+template <typename T>
+struct AssignFresh {
+    void operator()(T& value) const { value = T(); }
+};
+
+template <typename T, typename Reset = AssignFresh<T>>
+class ObjectPool {
+    struct Node {
+        T value;
+        Node* next = nullptr;
+    };
+
+public:
+    static const std::size_t SLAB_SIZE = 64;
+
+    // Owning reference to a pooled object; destroying it releases the object
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(Handle&& other) noexcept : pool(other.pool), node(other.node) { other.node = nullptr; }
+        Handle& operator=(Handle&& other) noexcept {
+            if (this != &other) {
+                release();
+                pool = other.pool;
+                node = other.node;
+                other.node = nullptr;
+            }
+            return *this;
+        }
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle() { release(); }
+
+        T& operator*() const { return node->value; }
+        T* operator->() const { return &node->value; }
+        explicit operator bool() const { return node != nullptr; }
+
+    private:
+        friend class ObjectPool;
+        Handle(ObjectPool* pool, Node* node) : pool(pool), node(node) {}
+
+        void release() {
+            if (node != nullptr) pool->release(node);
+            node = nullptr;
+        }
+
+        ObjectPool* pool = nullptr;
+        Node* node = nullptr;
+    };
+
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Owner thread only
+    Handle acquire() {
+        if (freeList == nullptr) freeList = returned.exchange(nullptr, std::memory_order_acquire);
+        if (freeList == nullptr) grow();
+        Node* node = freeList;
+        freeList = node->next;
+        node->next = nullptr;
+        return Handle(this, node);
+    }
+
+    // Objects ever created; owner thread only
+    std::size_t capacity() const { return slabs.size() * SLAB_SIZE; }
+
+private:
+    std::vector<std::unique_ptr<Node[]>> slabs;  // Owner thread only
+    Node* freeList = nullptr;                    // Owner thread only
+    std::atomic<Node*> returned{nullptr};
+
+    void grow() {
+        slabs.emplace_back(new Node[SLAB_SIZE]);
+        Node* slab = slabs.back().get();
+        for (std::size_t i = 0; i < SLAB_SIZE; ++i) slab[i].next = i + 1 < SLAB_SIZE ? &slab[i + 1] : nullptr;
+        freeList = slab;
+    }
+
+    void release(Node* node) {
+        Reset()(node->value);
+        Node* head = returned.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!returned.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+};
+
+#endif  // OBJECT_POOL_HPP
@@ -0,0 +1,45 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include "work_stealing_pool.hpp"
+
+// Minimum number of items worth handing to a separate thread
+static const std::size_t PARALLEL_GRAIN = 4096;
+
+// Map a requested thread count to a usable one; 0 means "all hardware threads"
+inline unsigned resolveThreadCount(unsigned requested) {
+    if (requested > 0) return requested;
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+// Number of chunks to split n items into so that each chunk is at least PARALLEL_GRAIN long
+inline unsigned chunkCount(std::size_t n, unsigned numThreads) {
+    std::size_t byGrain = (n + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+    return static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(numThreads, byGrain)));
+}
+
+// Split [0, n) into `chunks` contiguous ranges and run fn(chunk, begin, end) on each.
+// The chunks are forked onto the shared work-stealing pool; the calling thread runs the
+// first chunk itself and then helps with whatever is still queued until all are done.
+template <typename Fn>
+void parallelChunks(std::size_t n, unsigned chunks, Fn&& fn) {
+    if (chunks <= 1) {
+        fn(0u, std::size_t(0), n);
+        return;
+    }
+    TaskGroup group;
+    for (unsigned c = 1; c < chunks; ++c) {
+        group.run([&fn, c, n, chunks]() {
+            fn(c, n * c / chunks, n * (c + 1) / chunks);
+        });
+    }
+    fn(0u, std::size_t(0), n / chunks);
+    group.wait();
+}
+
+#endif  // PARALLEL_HPP
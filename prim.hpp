@@ -2,12 +2,25 @@
 #define PRIM_MST_HPP
 
 #include "graph.hpp"
+#include "cancel_token.hpp"
 #include <vector>
 #include <tuple>
 
+// On a disconnected graph both variants restart from the first vertex outside every tree so
+// far and return a minimum spanning forest
 class PrimMST {
 public:
-    std::vector<std::tuple<int, int, int>> computeMST(Graph& graph);
+    explicit PrimMST(bool verbose = true, const CancelToken* cancel = nullptr);
+
+    // Indexed 4-ary heap with decrease-key, O(E log V)
+    std::vector<std::tuple<int, int, int>> computeMST(const Graph& graph);
+
+    // Array-scan variant, O(V^2 + E), for near-complete graphs
+    std::vector<std::tuple<int, int, int>> computeDenseMST(const Graph& graph);
+
+private:
+    bool verbose;  // Print every selected edge and the total weight
+    const CancelToken* cancel;  // Polled once per vertex added to the tree
 };
 
 #endif  // PRIM_MST_HPP
@@ -0,0 +1,70 @@
+#ifndef RADIX_SORT_HPP
+#define RADIX_SORT_HPP
+
+#include "parallel.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Stable LSD radix sort of the positions 0..n-1 by their integer key, 8 bits per pass.
+// Passes whose digit is the same for every key are skipped, so small weight ranges only
+// pay for the bytes they use. Large inputs histogram and scatter in parallel: each chunk
+// owns a contiguous input range and writes to precomputed, disjoint output offsets.
+inline std::vector<std::uint32_t> radixSortIndices(const std::vector<int>& keys, unsigned numThreads = 1) {
+    const std::size_t n = keys.size();
+    const int RADIX = 256;
+    const unsigned chunks = chunkCount(n, numThreads);
+
+    // Bias the sign bit so negative weights order before positive ones
+    std::vector<std::uint32_t> key(n), keyTmp(n);
+    std::vector<std::uint32_t> index(n), indexTmp(n);
+    parallelChunks(n, chunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            key[i] = static_cast<std::uint32_t>(keys[i]) ^ 0x80000000u;
+            index[i] = static_cast<std::uint32_t>(i);
+        }
+    });
+
+    std::vector<std::size_t> counts(static_cast<std::size_t>(chunks) * RADIX);
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::fill(counts.begin(), counts.end(), 0);
+        parallelChunks(n, chunks, [&](unsigned chunk, std::size_t lo, std::size_t hi) {
+            std::size_t* local = &counts[static_cast<std::size_t>(chunk) * RADIX];
+            for (std::size_t i = lo; i < hi; ++i) ++local[(key[i] >> shift) & 0xFF];
+        });
+
+        // Skip the pass when every key shares this digit
+        bool trivial = false;
+        for (int digit = 0; digit < RADIX && !trivial; ++digit) {
+            std::size_t total = 0;
+            for (unsigned c = 0; c < chunks; ++c) total += counts[static_cast<std::size_t>(c) * RADIX + digit];
+            if (total == n) trivial = true;
+        }
+        if (trivial) continue;
+
+        // Exclusive prefix in (digit, chunk) order keeps the sort stable
+        std::size_t running = 0;
+        for (int digit = 0; digit < RADIX; ++digit) {
+            for (unsigned c = 0; c < chunks; ++c) {
+                std::size_t& slot = counts[static_cast<std::size_t>(c) * RADIX + digit];
+                std::size_t count = slot;
+                slot = running;
+                running += count;
+            }
+        }
+
+        parallelChunks(n, chunks, [&](unsigned chunk, std::size_t lo, std::size_t hi) {
+            std::size_t* offset = &counts[static_cast<std::size_t>(chunk) * RADIX];
+            for (std::size_t i = lo; i < hi; ++i) {
+                std::size_t dst = offset[(key[i] >> shift) & 0xFF]++;
+                keyTmp[dst] = key[i];
+                indexTmp[dst] = index[i];
+            }
+        });
+        key.swap(keyTmp);
+        index.swap(indexTmp);
+    }
+    return index;
+}
+
+#endif  // RADIX_SORT_HPP
@@ -0,0 +1,190 @@
+#ifndef RCU_HPP
+#define RCU_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Epoch-based read-copy-update.
+// Readers announce the global epoch in a per-thread slot for as long as they hold a pointer,
+// without taking any lock. Writers swap in a new object, advance the epoch and retire the old
+// object; it is deleted once every reader slot is idle or has moved past the retire epoch.
+// Reclamation is deferred to later publishes, so writers never wait for readers either.
+// A thread claims its slot on first use and frees it when it exits; when all slots are
+// taken the table grows by another block, so any number of threads can read at once.
+class RcuDomain {
+public:
+    static const int SLOTS_PER_BLOCK = 64;
+
+    static RcuDomain& instance() {
+        static RcuDomain domain;
+        return domain;
+    }
+
+    void enter() {
+        ThreadSlot& slot = threadSlot();
+        if (slot.depth++ == 0) {
+            slot.reader->epoch.store(epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+    }
+
+    void exit() {
+        ThreadSlot& slot = threadSlot();
+        if (--slot.depth == 0) slot.reader->epoch.store(0, std::memory_order_release);
+    }
+
+    // Advance the epoch; objects retired at the returned value are unreachable for new readers
+    std::uint64_t advance() { return epoch.fetch_add(1, std::memory_order_seq_cst) + 1; }
+
+    // True once no reader can still hold an object retired at retireEpoch
+    bool quiescent(std::uint64_t retireEpoch) const {
+        for (const SlotBlock* block = &first; block != nullptr; block = block->next.load(std::memory_order_acquire)) {
+            for (const auto& reader : block->readers) {
+                std::uint64_t active = reader.epoch.load(std::memory_order_seq_cst);
+                if (active != 0 && active < retireEpoch) return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::uint64_t> epoch{0};  // 0 while the thread is outside a read section
+        std::atomic<bool> owned{false};
+    };
+
+    // Slots come in blocks chained into a list that only ever grows, so a slot's address
+    // stays valid for the life of the process and scans need no lock
+    struct SlotBlock {
+        ReaderSlot readers[SLOTS_PER_BLOCK];
+        std::atomic<SlotBlock*> next{nullptr};
+    };
+
+    struct ThreadSlot {
+        ReaderSlot* reader = nullptr;
+        int depth = 0;
+        ~ThreadSlot() {
+            if (reader != nullptr) reader->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<std::uint64_t> epoch{1};
+    SlotBlock first;
+
+    RcuDomain() = default;
+    ~RcuDomain() {
+        SlotBlock* block = first.next.load();
+        while (block != nullptr) {
+            SlotBlock* next = block->next.load();
+            delete block;
+            block = next;
+        }
+    }
+
+    // Claim a free slot for this thread, appending a block when every slot is taken
+    ThreadSlot& threadSlot() {
+        thread_local ThreadSlot slot;
+        if (slot.reader != nullptr) return slot;
+        SlotBlock* block = &first;
+        while (true) {
+            for (auto& reader : block->readers) {
+                bool expected = false;
+                if (reader.owned.compare_exchange_strong(expected, true)) {
+                    slot.reader = &reader;
+                    return slot;
+                }
+            }
+            SlotBlock* next = block->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                SlotBlock* grown = new SlotBlock();
+                if (block->next.compare_exchange_strong(next, grown, std::memory_order_acq_rel)) {
+                    next = grown;
+                } else {
+                    delete grown;  // Another thread appended first; next now points at its block
+                }
+            }
+            block = next;
+        }
+    }
+};
+
+// A published object readers can pin without locks and writers replace wholesale
+template <typename T>
+class RcuCell {
+public:
+    // Keeps the epoch pinned, and therefore the object alive, for the guard's lifetime
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const RcuCell& cell) : pinned(true) {
+            RcuDomain::instance().enter();
+            object = cell.current.load(std::memory_order_seq_cst);
+        }
+        ~ReadGuard() {
+            if (pinned) RcuDomain::instance().exit();
+        }
+        ReadGuard(ReadGuard&& other) noexcept : object(other.object), pinned(other.pinned) {
+            other.object = nullptr;
+            other.pinned = false;
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        const T& operator*() const { return *object; }
+        const T* operator->() const { return object; }
+        const T* get() const { return object; }
+
+    private:
+        const T* object = nullptr;
+        bool pinned = false;
+    };
+
+    explicit RcuCell(std::unique_ptr<T> initial) : current(initial.release()) {}
+    ~RcuCell() {
+        delete current.load();
+        for (auto& entry : retired) delete entry.first;
+    }
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ReadGuard read() const { return ReadGuard(*this); }
+
+    // Run fn(const T& current) -> std::unique_ptr<T> under the writer lock and publish the result
+    template <typename Fn>
+    void update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(writeMtx);
+        std::unique_ptr<T> next = fn(static_cast<const T&>(*current.load(std::memory_order_acquire)));
+        publishLocked(std::move(next));
+    }
+
+    void publish(std::unique_ptr<T> next) {
+        std::lock_guard<std::mutex> lock(writeMtx);
+        publishLocked(std::move(next));
+    }
+
+private:
+    std::atomic<T*> current;
+    std::mutex writeMtx;                             // Serializes writers only
+    std::vector<std::pair<T*, std::uint64_t>> retired;  // Old versions and their retire epochs
+
+    void publishLocked(std::unique_ptr<T> next) {
+        T* old = current.exchange(next.release(), std::memory_order_seq_cst);
+        retired.push_back({old, RcuDomain::instance().advance()});
+
+        RcuDomain& domain = RcuDomain::instance();
+        std::size_t kept = 0;
+        for (auto& entry : retired) {
+            if (domain.quiescent(entry.second)) {
+                delete entry.first;
+            } else {
+                retired[kept++] = entry;
+            }
+        }
+        retired.resize(kept);
+    }
+};
+
+#endif  // RCU_HPP
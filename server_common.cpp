@@ -0,0 +1,290 @@
+#include "server_common.hpp"
+#include <iostream>
+#include <memory>
+#include "graph_snapshot.hpp"
+#include "metrics.hpp"
+#include "mst_factory.hpp"
+#include "shortest_path.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <climits>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+bool flushOutput(int fd, std::string& output) {
+    std::size_t sent = 0;
+    bool ok = true;
+    while (sent < output.size()) {
+        ssize_t n = send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<std::size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            ok = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+    }
+    output.erase(0, sent);
+    return ok;
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool takeLine(std::string& buffer, std::string& line) {
+    std::size_t end = buffer.find('\n');
+    if (end == std::string::npos) return false;
+    std::size_t length = end;
+    if (length > 0 && buffer[length - 1] == '\r') --length;
+    line.assign(buffer, 0, length);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+int parseInts(const std::string& text, int* values, int count) {
+    const char* cursor = text.c_str();
+    int parsed = 0;
+    while (parsed < count) {
+        char* next = nullptr;
+        errno = 0;
+        long value = std::strtol(cursor, &next, 10);
+        if (next == cursor || errno == ERANGE || value < INT_MIN || value > INT_MAX) break;
+        values[parsed++] = static_cast<int>(value);
+        cursor = next;
+    }
+    return parsed;
+}
+
+std::string trimmed(const std::string& text) {
+    const char* space = " \t\r\n";
+    std::size_t begin = text.find_first_not_of(space);
+    if (begin == std::string::npos) return std::string();
+    return text.substr(begin, text.find_last_not_of(space) - begin + 1);
+}
+
+namespace {
+
+std::string dataDir;  // Set before any client connects, read-only afterwards
+
+}  // namespace
+
+void setDataDir(const std::string& dir) {
+    dataDir = dir;
+    while (dataDir.size() > 1 && dataDir.back() == '/') dataDir.pop_back();
+}
+
+bool resolveDataPath(const std::string& path, std::string& resolved, std::string& error) {
+    bool valid = !path.empty() && path[0] != '/' && path.find('\0') == std::string::npos;
+    for (std::size_t begin = 0; valid && begin <= path.size();) {
+        std::size_t end = path.find('/', begin);
+        if (end == std::string::npos) end = path.size();
+        valid = path.compare(begin, end - begin, "..") != 0;
+        begin = end + 1;
+    }
+    if (!valid) {
+        error = "Invalid path '" + path + "': paths are relative to the server's data directory and may not contain '..'";
+        return false;
+    }
+    resolved = dataDir.empty() ? path : dataDir + "/" + path;
+    return true;
+}
+
+std::size_t parseWord(const std::string& text, std::string& word) {
+    const char* space = " \t\r\n";
+    std::size_t begin = text.find_first_not_of(space);
+    if (begin == std::string::npos) return 0;
+    std::size_t end = text.find_first_of(space, begin);
+    if (end == std::string::npos) end = text.size();
+    word.assign(text, begin, end - begin);
+    return end;
+}
+
+TreePath timedTreePath(const Graph& graph, int start, int end) {
+    static const int metric = Metrics::histogram("compute.tree_path");
+    Metrics::ScopedTimer timer(metric);
+    return graph.getTreePath(start, end);
+}
+
+std::vector<int> commandMetrics(const std::vector<std::string>& names) {
+    std::vector<int> ids;
+    for (const auto& name : names) ids.push_back(Metrics::histogram("command.text." + name));
+    return ids;
+}
+
+int commandMetric(const std::vector<int>& ids, int choice) {
+    return ids[choice > 0 && static_cast<std::size_t>(choice) < ids.size() ? choice : 0];
+}
+
+std::string formatTreePath(const std::string& label, int start, int end, const TreePath& path) {
+    if (!path.connected) {
+        return "No path in MST between " + std::to_string(start) + " and " + std::to_string(end) + "\n";
+    }
+    return label + ": " + std::to_string(path.length) + " (edges: " + std::to_string(path.edgeCount) +
+           ", max edge: " + std::to_string(path.maxEdge) + ", min edge: " + std::to_string(path.minEdge) + ")\n";
+}
+
+std::string formatMST(const Graph& graph) { return formatMST(graph.getMST()); }
+
+std::string formatMST(const std::vector<std::tuple<int, int, int>>& tree) {
+    std::string out;
+    for (const auto& edge : tree) {
+        out += std::to_string(std::get<1>(edge)) + " -- " + std::to_string(std::get<2>(edge)) +
+               " [weight=" + std::to_string(std::get<0>(edge)) + "]\n";
+    }
+    return out;
+}
+
+std::vector<std::tuple<int, int, int>> timedMST(const Graph& graph, const std::string& algorithm) {
+    static const int metric = Metrics::histogram("compute.mst");
+    Metrics::ScopedTimer timer(metric);
+    MSTOptions options;
+    options.verbose = false;
+    return MSTFactory::computeMST(graph, algorithm, options);
+}
+
+SpanningForest timedForest(const Graph& graph) {
+    static const int metric = Metrics::histogram("compute.forest");
+    Metrics::ScopedTimer timer(metric);
+    MSTOptions options;
+    options.verbose = false;
+    return MSTFactory::computeForest(graph, "kruskal", options);
+}
+
+std::string formatForest(const SpanningForest& forest) {
+    static const std::size_t TREES_SHOWN = 10;
+    std::string out = "Spanning forest: " + std::to_string(forest.trees.size()) + " trees, " +
+                      std::to_string(forest.edgeCount()) + " edges, total weight " +
+                      std::to_string(forest.totalWeight()) + "\n";
+    for (std::size_t index : forest.largest(TREES_SHOWN)) {
+        const ComponentTree& tree = forest.trees[index];
+        out += "Tree at " + std::to_string(tree.root) + ": " + std::to_string(tree.vertices) + " vertices, " +
+               std::to_string(tree.stats.edgeCount) + " edges, weight " + std::to_string(tree.stats.totalWeight) +
+               ", heaviest edge " + std::to_string(tree.stats.heaviestEdge) + ", diameter " +
+               std::to_string(tree.stats.diameter) + ", average distance " +
+               std::to_string(tree.stats.averageDistance) + "\n";
+    }
+    if (forest.trees.size() > TREES_SHOWN) {
+        out += "(" + std::to_string(forest.trees.size() - TREES_SHOWN) + " smaller trees not shown)\n";
+    }
+    return out;
+}
+
+std::string invalidVertexCount() {
+    return "Invalid number of vertices (1.." + std::to_string(Graph::vertexLimit()) + " allowed).\n";
+}
+
+std::string createNamedGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, const std::string& name, int V) {
+    if (!GraphRegistry::isValidName(name)) return "Invalid graph name.\n";
+    if (!Graph::isValidVertexCount(V)) return invalidVertexCount();
+    GraphRegistry::Handle created = graphs.create(name, V);
+    if (!created) return "Graph '" + name + "' already exists.\n";
+    current = created;
+    return "Graph '" + name + "' created with " + std::to_string(V) + " vertices and opened.\n";
+}
+
+std::string openNamedGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, const std::string& name) {
+    GraphRegistry::Handle found = graphs.open(name);
+    if (!found) return "No graph named '" + name + "'.\n";
+    current = found;
+    return "Opened graph '" + name + "' (" + std::to_string(found->store.snapshot()->V) + " vertices).\n";
+}
+
+std::string dropNamedGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, const std::string& name) {
+    if (name == GraphRegistry::DEFAULT_GRAPH) return "The default graph cannot be dropped.\n";
+    if (!graphs.drop(name)) return "No graph named '" + name + "'.\n";
+    if (current && current->name == name) {
+        current = graphs.open(GraphRegistry::DEFAULT_GRAPH);
+        return "Graph '" + name + "' dropped; switched to '" + GraphRegistry::DEFAULT_GRAPH + "'.\n";
+    }
+    return "Graph '" + name + "' dropped.\n";
+}
+
+std::string submitMSTJob(JobManager& jobs, const GraphRegistry::Handle& current, const std::string& algorithm, int timeoutMs) {
+    if (!MSTFactory::isKnown(algorithm)) return "Unknown MST algorithm '" + algorithm + "'.\n";
+    JobSpec spec;
+    spec.kind = JobSpec::MST;
+    spec.algorithm = algorithm;
+    std::uint64_t id = jobs.submit(current, spec, std::chrono::milliseconds(timeoutMs));
+    return "Submitted MST job " + std::to_string(id) + ".\n";
+}
+
+std::string submitPathJob(JobManager& jobs, const GraphRegistry::Handle& current, int start, int end, int timeoutMs) {
+    JobSpec spec;
+    spec.kind = JobSpec::SHORTEST_PATH;
+    spec.start = start;
+    spec.end = end;
+    std::uint64_t id = jobs.submit(current, spec, std::chrono::milliseconds(timeoutMs));
+    return "Submitted shortest path job " + std::to_string(id) + ".\n";
+}
+
+std::string jobStatus(const JobManager& jobs, int id) {
+    JobManager::State state;
+    if (id <= 0 || !jobs.status(static_cast<std::uint64_t>(id), state)) return "No job " + std::to_string(id) + ".\n";
+    return "Job " + std::to_string(id) + " is " + JobManager::stateName(state) + ".\n";
+}
+
+std::string takeJobResult(JobManager& jobs, int id) {
+    JobManager::State state;
+    JobResult result;
+    if (id <= 0 || !jobs.result(static_cast<std::uint64_t>(id), state, result)) return "No job " + std::to_string(id) + ".\n";
+    std::string label = "Job " + std::to_string(id);
+    if (state != JobManager::DONE) return label + " is " + JobManager::stateName(state) + ", no result.\n";
+    if (result.kind == JobSpec::MST) {
+        return label + ": total weight of MST " + std::to_string(result.value) + " (" + std::to_string(result.edges) + " edges)\n";
+    }
+    if (result.value == ShortestPath::NEGATIVE_CYCLE) return label + ": no shortest path (negative edge reachable)\n";
+    if (result.value < 0) return label + ": no path\n";
+    return label + ": shortest distance " + std::to_string(result.value) + "\n";
+}
+
+std::string cancelJob(JobManager& jobs, int id) {
+    if (id <= 0 || !jobs.cancel(static_cast<std::uint64_t>(id))) return "No running job " + std::to_string(id) + ".\n";
+    return "Cancelling job " + std::to_string(id) + ".\n";
+}
+
+bool checkCurrentGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, std::string& notice) {
+    if (current && !current->dropped.load(std::memory_order_acquire)) return true;
+    std::string name = current ? current->name : std::string();
+    current = graphs.open(GraphRegistry::DEFAULT_GRAPH);
+    notice = "Graph '" + name + "' was dropped; switched to '" + GraphRegistry::DEFAULT_GRAPH + "'.\n";
+    return false;
+}
+
+bool preloadSnapshot(GraphRegistry& graphs, const std::string& spec) {
+    // Graph names cannot contain '=', so only a valid name before the first one is taken as
+    // the graph; otherwise the whole spec is a path, '=' and all
+    std::size_t split = spec.find('=');
+    std::string name = GraphRegistry::DEFAULT_GRAPH, path = spec;
+    if (split == 0) {
+        std::cerr << "Invalid --preload '" << spec << "': empty graph name\n";
+        return false;
+    }
+    if (split != std::string::npos && GraphRegistry::isValidName(spec.substr(0, split))) {
+        name = spec.substr(0, split);
+        path = spec.substr(split + 1);
+    }
+    if (path.empty()) {
+        std::cerr << "Invalid --preload '" << spec << "': empty snapshot path\n";
+        return false;
+    }
+
+    GraphRegistry::Handle graph = graphs.open(name);
+    if (!graph) graph = graphs.create(name, 0);
+    if (!graph) {
+        std::cerr << "Cannot preload into graph '" << name << "'\n";
+        return false;
+    }
+    auto result = std::make_shared<GraphSnapshot::Result>();
+    try {
+        graphs.update(graph, GraphSnapshot::loadInto(path, result)).get();
+    } catch (const std::exception& error) {
+        result->ok = false;
+        result->error = error.what();
+    }
+    (result->ok ? std::cout : std::cerr) << GraphSnapshot::describe(*result, path, false) << " into graph '" << name
+                                         << "'" << std::endl;
+    return result->ok;
+}
@@ -0,0 +1,108 @@
+#ifndef SERVER_COMMON_HPP
+#define SERVER_COMMON_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "graph_registry.hpp"
+#include "job_manager.hpp"
+#include "spanning_forest.hpp"
+
+// Write as much of output as the non-blocking socket accepts now and erase that part; the
+// rest waits for EPOLLOUT. False if the connection failed.
+bool flushOutput(int fd, std::string& output);
+
+// Reply bytes a connection may have waiting before the server stops reading its requests,
+// so a client that pipelines requests without reading the answers cannot exhaust memory
+const std::size_t MAX_OUTPUT_BACKLOG = std::size_t(16) << 20;
+
+bool setNonBlocking(int fd);
+
+// Longest text line a client may send; a connection whose unfinished line grows past it is
+// told so and closed, so a peer that never sends '\n' cannot grow the input buffer forever
+const std::size_t MAX_LINE_LENGTH = 4096;
+const char* const LINE_TOO_LONG = "Line too long; closing the connection.\n";
+
+// Most bytes one readiness event reads from a client before its input is processed, so a
+// fast sender cannot keep a thread in the read loop or balloon the buffer in one go
+const std::size_t MAX_READ_PER_EVENT = std::size_t(1) << 20;
+
+// Move the first complete line out of buffer (without its line ending); false if none yet
+bool takeLine(std::string& buffer, std::string& line);
+
+// Parse up to `count` whitespace-separated integers; returns how many were read
+int parseInts(const std::string& text, int* values, int count);
+
+// The text without leading and trailing whitespace
+std::string trimmed(const std::string& text);
+
+// Copy the first whitespace-separated word into `word`; returns the offset just past it,
+// or 0 when the text holds no word
+std::size_t parseWord(const std::string& text, std::string& word);
+
+// Files named by clients (edge lists and snapshots) live under the data directory, set once
+// at startup from --data-dir; the working directory by default. Operator-given paths such as
+// --preload are not restricted.
+void setDataDir(const std::string& dir);
+
+// Resolve a client's path under the data directory. Absolute paths and paths with a ".."
+// component are refused, so a client cannot reach files outside it: false, with the reply
+// in error.
+bool resolveDataPath(const std::string& path, std::string& resolved, std::string& error);
+
+// Describe an MST path query result for the client
+std::string formatTreePath(const std::string& label, int start, int end, const TreePath& path);
+
+// The MST path between two vertices, timed into the "compute.tree_path" histogram
+TreePath timedTreePath(const Graph& graph, int start, int end);
+
+// Histogram ids "command.text.<name>" for a menu whose option i is names[i]; names[0] names
+// the bucket for invalid choices. commandMetric maps a choice to its id.
+std::vector<int> commandMetrics(const std::vector<std::string>& names);
+int commandMetric(const std::vector<int>& ids, int choice);
+
+// Render the graph's maintained MST edges, or a computed tree, for the client
+std::string formatMST(const Graph& graph);
+std::string formatMST(const std::vector<std::tuple<int, int, int>>& tree);
+
+// MST of the graph computed from scratch by the named MSTFactory algorithm, timed into the
+// "compute.mst" histogram
+std::vector<std::tuple<int, int, int>> timedMST(const Graph& graph, const std::string& algorithm);
+
+// The graph's minimum spanning forest with per-tree statistics, timed into the
+// "compute.forest" histogram
+SpanningForest timedForest(const Graph& graph);
+
+// Summarize a spanning forest for the client: totals, then the largest trees
+std::string formatForest(const SpanningForest& forest);
+
+// Reply to a vertex count outside 1..Graph::vertexLimit()
+std::string invalidVertexCount();
+
+// Registry commands shared by both servers. Each may move the session's current graph and
+// returns the reply for the client.
+std::string createNamedGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, const std::string& name, int V);
+std::string openNamedGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, const std::string& name);
+std::string dropNamedGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, const std::string& name);
+
+// Background job commands shared by both servers; each returns the reply for the client.
+// A timeout of 0 or less means the job manager's default.
+std::string submitMSTJob(JobManager& jobs, const GraphRegistry::Handle& current, const std::string& algorithm, int timeoutMs);
+std::string submitPathJob(JobManager& jobs, const GraphRegistry::Handle& current, int start, int end, int timeoutMs);
+std::string jobStatus(const JobManager& jobs, int id);
+std::string takeJobResult(JobManager& jobs, int id);
+std::string cancelJob(JobManager& jobs, int id);
+
+// Load a snapshot given as "[graph=]path" into the registry before serving, creating the
+// named graph (or using the default one); prints the outcome. The text before the first '='
+// names the graph only if it is a valid graph name (which never contains '='), so a path
+// such as "runs/a=1.snap" loads into the default graph, while "x=y.snap" loads y.snap into
+// graph x (write "default=x=y.snap" for the file). An empty name or path is refused.
+bool preloadSnapshot(GraphRegistry& graphs, const std::string& spec);
+
+// False if the session's graph was dropped by someone else; the session is then moved to the
+// default graph and `notice` explains why its request was not run
+bool checkCurrentGraph(GraphRegistry& graphs, GraphRegistry::Handle& current, std::string& notice);
+
+#endif  // SERVER_COMMON_HPP
@@ -0,0 +1,136 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Text-menu exit test for one server: starts it, then sends the exit choice in the forms the
+// menu parser accepts ("9\r\n", " 9\n", ...) followed by more requests in the same segment.
+// The server must answer with a single goodbye, ignore everything after it and close, and
+// stay healthy for the next connections. Run by `make test` as
+//   ./server_test ./pipeline_server 8080 9
+//   ./server_test ./leader_follower_server 8081 10
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (ok) return;
+    ++failures;
+    std::cerr << "FAIL: " << what << "\n";
+}
+
+int connectTo(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    timeval timeout{5, 0};  // A connection left open would otherwise hang the test
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send text and read until the server closes; false if it is still open after the timeout
+bool exchange(int port, const std::string& text, std::string& received) {
+    int fd = connectTo(port);
+    if (fd < 0) return false;
+    send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) received.append(buffer, static_cast<std::size_t>(n));
+    close(fd);
+    return n == 0;
+}
+
+// Send an MST query and wait for its reply: the menu comes once on connect and once more
+// after every reply
+bool responds(int port) {
+    int fd = connectTo(port);
+    if (fd < 0) return false;
+    send(fd, "4\n", 2, MSG_NOSIGNAL);
+    std::string received;
+    char buffer[4096];
+    ssize_t n;
+    auto menus = [&received]() {
+        std::size_t first = received.find("Menu:");
+        return first != std::string::npos && received.find("Menu:", first + 1) != std::string::npos;
+    };
+    while (!menus() && (n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        received.append(buffer, static_cast<std::size_t>(n));
+    }
+    close(fd);
+    return menus();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " SERVER PORT EXIT_CHOICE\n";
+        return 2;
+    }
+    const int port = std::atoi(argv[2]);
+    const std::string exitChoice = argv[3];
+    if (responds(port)) {
+        std::cerr << "Port " << port << " is already in use\n";
+        return 2;
+    }
+
+    pid_t server = fork();
+    if (server == 0) {
+        int quiet = open("/dev/null", O_WRONLY);  // Keep the server's connection log out of the report
+        if (quiet >= 0) dup2(quiet, STDOUT_FILENO);
+        execl(argv[1], argv[1], static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    bool up = false;
+    for (int attempt = 0; attempt < 100 && !up; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        up = responds(port);
+    }
+    check(up, std::string(argv[1]) + " did not start");
+
+    const std::vector<std::string> forms = {exitChoice + "\r\n", " " + exitChoice + "\n",
+                                            exitChoice + " \r\n", "\t" + exitChoice + "\t\n"};
+    for (int round = 0; up && round < 25; ++round) {
+        for (const auto& form : forms) {
+            std::string received;
+            // A graph is created first, so the trailing queries would have something to answer
+            bool closed = exchange(port, "1\n3\n" + form + "4\n4\n2\n0 1 5\n4\n", received);
+            std::string what = "exit as \"" + form.substr(0, form.size() - 1) + "\"";
+            check(closed, what + ": connection left open");
+            std::size_t goodbye = received.find("Goodbye!\n");
+            check(goodbye != std::string::npos, what + ": no goodbye");
+            check(goodbye == std::string::npos || goodbye + 9 == received.size(),
+                  what + ": replies after the goodbye");
+            check(received.find("Total weight") == std::string::npos, what + ": later requests were answered");
+        }
+    }
+    check(responds(port), std::string(argv[1]) + " stopped answering");
+    check(waitpid(server, nullptr, WNOHANG) == 0, std::string(argv[1]) + " exited");
+
+    kill(server, SIGKILL);
+    waitpid(server, nullptr, 0);
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "Exit handling checks passed for " << argv[1] << "\n";
+    return 0;
+}
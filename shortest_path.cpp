@@ -0,0 +1,253 @@
+#include "shortest_path.hpp"
+#include "graph.hpp"
+#include "cancel_token.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const long long UNREACHED = std::numeric_limits<long long>::max();
+
+// Largest maximum edge weight served by the Dial bucket queue
+const int DIAL_MAX_WEIGHT = 1 << 12;
+
+// Circular bucket queue for keys that never exceed the current minimum by more than maxWeight
+class DialQueue {
+    std::vector<std::vector<int>> buckets;
+    std::size_t pending = 0;
+    long long current = 0;
+
+public:
+    void reset(int maxWeight) {
+        buckets.resize(static_cast<std::size_t>(maxWeight) + 1);
+        for (auto& bucket : buckets) bucket.clear();
+        pending = 0;
+        current = 0;
+    }
+    bool empty() const { return pending == 0; }
+    void push(long long key, int vertex) {
+        buckets[static_cast<std::size_t>(key % static_cast<long long>(buckets.size()))].push_back(vertex);
+        ++pending;
+    }
+    long long topKey() {
+        while (buckets[static_cast<std::size_t>(current % static_cast<long long>(buckets.size()))].empty()) ++current;
+        return current;
+    }
+    std::pair<long long, int> pop() {
+        long long key = topKey();
+        auto& bucket = buckets[static_cast<std::size_t>(key % static_cast<long long>(buckets.size()))];
+        int vertex = bucket.back();
+        bucket.pop_back();
+        --pending;
+        return {key, vertex};
+    }
+};
+
+// Monotone radix heap: keys are bucketed by the highest bit that differs from the last pop
+class RadixHeap {
+    std::vector<std::pair<std::uint64_t, int>> buckets[65];
+    std::size_t pending = 0;
+    std::uint64_t last = 0;
+
+    static int bucketOf(std::uint64_t key, std::uint64_t last) {
+        return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+    }
+
+    void refill() {
+        if (!buckets[0].empty()) return;
+        int i = 1;
+        while (buckets[i].empty()) ++i;
+        std::uint64_t smallest = buckets[i][0].first;
+        for (const auto& entry : buckets[i]) smallest = std::min(smallest, entry.first);
+        last = smallest;
+        for (const auto& entry : buckets[i]) buckets[bucketOf(entry.first, last)].push_back(entry);
+        buckets[i].clear();
+    }
+
+public:
+    void reset(int) {
+        for (auto& bucket : buckets) bucket.clear();
+        pending = 0;
+        last = 0;
+    }
+    bool empty() const { return pending == 0; }
+    void push(long long key, int vertex) {
+        buckets[bucketOf(static_cast<std::uint64_t>(key), last)].push_back({static_cast<std::uint64_t>(key), vertex});
+        ++pending;
+    }
+    long long topKey() {
+        refill();
+        return static_cast<long long>(last);
+    }
+    std::pair<long long, int> pop() {
+        refill();
+        auto entry = buckets[0].back();
+        buckets[0].pop_back();
+        --pending;
+        return {static_cast<long long>(entry.first), entry.second};
+    }
+};
+
+// One search direction: tentative distances plus the list of entries to reset afterwards
+struct SearchSide {
+    std::vector<long long> dist;
+    std::vector<int> touched;
+    DialQueue dial;
+    RadixHeap radix;
+
+    void prepare(int V) {
+        if (static_cast<int>(dist.size()) < V) dist.resize(V, UNREACHED);
+    }
+    void clear() {
+        for (int v : touched) dist[v] = UNREACHED;
+        touched.clear();
+    }
+    void set(int v, long long d) {
+        if (dist[v] == UNREACHED) touched.push_back(v);
+        dist[v] = d;
+    }
+};
+
+struct Scratch {
+    SearchSide forward;
+    SearchSide backward;
+};
+
+Scratch& threadScratch() {
+    thread_local Scratch scratch;
+    return scratch;
+}
+
+template <typename Queue>
+long long singleSource(const Graph& graph, int start, int end, SearchSide& side, Queue& queue,
+                       const CancelToken* cancel) {
+    queue.reset(graph.getMaxEdgeWeight());
+    side.set(start, 0);
+    queue.push(0, start);
+
+    std::size_t pops = 0;
+    while (!queue.empty()) {
+        if (CancelToken::poll(cancel, ++pops)) return -1;
+        auto top = queue.pop();
+        long long d = top.first;
+        int u = top.second;
+        if (d != side.dist[u]) continue;  // Stale entry
+        if (u == end) return d;           // Target settled, nothing shorter can follow
+
+        graph.forEachNeighbor(u, [&](int v, int weight) {
+            long long candidate = d + weight;
+            if (candidate < side.dist[v]) {
+                side.set(v, candidate);
+                queue.push(candidate, v);
+            }
+        });
+    }
+    return -1;
+}
+
+template <typename Queue>
+long long meetInTheMiddle(const Graph& graph, int start, int end, SearchSide& fwd, Queue& fq,
+                          SearchSide& bwd, Queue& bq, const CancelToken* cancel) {
+    fq.reset(graph.getMaxEdgeWeight());
+    bq.reset(graph.getMaxEdgeWeight());
+    fwd.set(start, 0);
+    bwd.set(end, 0);
+    fq.push(0, start);
+    bq.push(0, end);
+    long long best = start == end ? 0 : UNREACHED;
+
+    std::size_t pops = 0;
+    while (!fq.empty() && !bq.empty()) {
+        if (CancelToken::poll(cancel, ++pops)) return -1;
+        // Any path not yet found is at least as long as the two frontier minima together
+        if (best != UNREACHED && fq.topKey() + bq.topKey() >= best) break;
+
+        bool forwardTurn = fq.topKey() <= bq.topKey();
+        SearchSide& side = forwardTurn ? fwd : bwd;
+        SearchSide& other = forwardTurn ? bwd : fwd;
+        Queue& queue = forwardTurn ? fq : bq;
+
+        auto top = queue.pop();
+        long long d = top.first;
+        int u = top.second;
+        if (d != side.dist[u]) continue;
+
+        graph.forEachNeighbor(u, [&](int v, int weight) {
+            long long candidate = d + weight;
+            if (candidate < side.dist[v]) {
+                side.set(v, candidate);
+                queue.push(candidate, v);
+            }
+            if (other.dist[v] != UNREACHED) best = std::min(best, candidate + other.dist[v]);
+        });
+    }
+    return best == UNREACHED ? -1 : best;
+}
+
+// Graphs with negative weights: Dijkstra over start's component without the early exit, since
+// only a component free of negative edges has shortest paths at all; all distances it settles
+// before meeting a negative edge are exact, and the first one it meets ends the search
+long long guardedSearch(const Graph& graph, int start, int end, SearchSide& side, const CancelToken* cancel) {
+    std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>, std::greater<>> pq;
+    side.set(start, 0);
+    pq.push({0, start});
+    bool negative = false;
+    std::size_t pops = 0;
+    while (!pq.empty() && !negative) {
+        if (CancelToken::poll(cancel, ++pops)) return -1;
+        auto top = pq.top();
+        pq.pop();
+        if (top.first != side.dist[top.second]) continue;
+        graph.forEachNeighbor(top.second, [&](int v, int weight) {
+            if (weight < 0) negative = true;
+            long long candidate = top.first + weight;
+            if (!negative && candidate < side.dist[v]) {
+                side.set(v, candidate);
+                pq.push({candidate, v});
+            }
+        });
+    }
+    if (negative) return ShortestPath::NEGATIVE_CYCLE;
+    return side.dist[end] == UNREACHED ? -1 : side.dist[end];
+}
+
+}  // namespace
+
+namespace ShortestPath {
+
+long long distance(const Graph& graph, int start, int end, const CancelToken* cancel) {
+    if (!graph.isValidVertex(start) || !graph.isValidVertex(end)) return -1;
+
+    SearchSide& side = threadScratch().forward;
+    side.prepare(graph.V);
+    long long result = graph.getMinEdgeWeight() < 0 ? guardedSearch(graph, start, end, side, cancel)
+                       : graph.getMaxEdgeWeight() <= DIAL_MAX_WEIGHT
+                           ? singleSource(graph, start, end, side, side.dial, cancel)
+                           : singleSource(graph, start, end, side, side.radix, cancel);
+    side.clear();
+    return result;
+}
+
+long long bidirectionalDistance(const Graph& graph, int start, int end, const CancelToken* cancel) {
+    if (!graph.isValidVertex(start) || !graph.isValidVertex(end)) return -1;
+    if (graph.getMinEdgeWeight() < 0) return distance(graph, start, end, cancel);
+
+    Scratch& scratch = threadScratch();
+    scratch.forward.prepare(graph.V);
+    scratch.backward.prepare(graph.V);
+    long long result = graph.getMaxEdgeWeight() <= DIAL_MAX_WEIGHT
+                           ? meetInTheMiddle(graph, start, end, scratch.forward, scratch.forward.dial,
+                                             scratch.backward, scratch.backward.dial, cancel)
+                           : meetInTheMiddle(graph, start, end, scratch.forward, scratch.forward.radix,
+                                             scratch.backward, scratch.backward.radix, cancel);
+    scratch.forward.clear();
+    scratch.backward.clear();
+    return result;
+}
+
+}  // namespace ShortestPath
@@ -0,0 +1,26 @@
+#ifndef SHORTEST_PATH_HPP
+#define SHORTEST_PATH_HPP
+
+class Graph;
+class CancelToken;
+
+// Point-to-point shortest paths over the adjacency store for non-negative integer weights.
+// Small maximum weights use a Dial bucket queue, larger ones a radix heap. Searches stop as
+// soon as the target is settled and reuse thread-local scratch arrays, resetting only the
+// entries the previous query touched. Both return -1 when end is unreachable, and also when
+// the optional cancel token fires before the search finished.
+// An undirected edge of negative weight is a negative cycle (walk it back and forth), so no
+// vertex connected to one has a shortest path; on graphs with negative weights the search
+// covers start's whole component and returns NEGATIVE_CYCLE as soon as it meets one.
+namespace ShortestPath {
+
+const long long NEGATIVE_CYCLE = -2;
+
+long long distance(const Graph& graph, int start, int end, const CancelToken* cancel = nullptr);
+
+// Alternates a forward and a backward search and stops once their frontiers meet
+long long bidirectionalDistance(const Graph& graph, int start, int end, const CancelToken* cancel = nullptr);
+
+}  // namespace ShortestPath
+
+#endif  // SHORTEST_PATH_HPP
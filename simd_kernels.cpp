@@ -0,0 +1,196 @@
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+namespace Simd {
+
+namespace {
+
+void atomicMin(std::atomic<std::uint64_t>& slot, std::uint64_t key) {
+    std::uint64_t current = slot.load(std::memory_order_relaxed);
+    while (key < current && !slot.compare_exchange_weak(current, key, std::memory_order_relaxed)) {
+    }
+}
+
+WeightSummary finish(std::size_t n, long long sum, int min, int max, const int* tail, std::size_t tailCount) {
+    WeightSummary summary;
+    summary.count = n;
+    if (n == 0) return summary;
+    for (std::size_t i = 0; i < tailCount; ++i) {
+        sum += tail[i];
+        min = std::min(min, tail[i]);
+        max = std::max(max, tail[i]);
+    }
+    summary.sum = sum;
+    summary.min = min;
+    summary.max = max;
+    return summary;
+}
+
+WeightSummary summarizeScalar(const int* weights, std::size_t n) {
+    return finish(n, 0, INT_MAX, INT_MIN, weights, n);
+}
+
+void lowerCheapestScalar(const int* weights, const std::uint32_t* origin, const int* eu, const int* ev,
+                         std::size_t lo, std::size_t hi, std::atomic<std::uint64_t>* cheapest) {
+    for (std::size_t i = lo; i < hi; ++i) {
+        std::uint64_t key = edgeKey(weights[origin[i]], i);
+        atomicMin(cheapest[eu[i]], key);
+        atomicMin(cheapest[ev[i]], key);
+    }
+}
+
+#ifdef SIMD_X86
+
+__attribute__((target("sse4.1"))) WeightSummary summarizeSse4(const int* weights, std::size_t n) {
+    __m128i min = _mm_set1_epi32(INT_MAX), max = _mm_set1_epi32(INT_MIN);
+    __m128i sumLow = _mm_setzero_si128(), sumHigh = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        min = _mm_min_epi32(min, x);
+        max = _mm_max_epi32(max, x);
+        // Sign-extend to 64 bits so the sum cannot overflow
+        sumLow = _mm_add_epi64(sumLow, _mm_cvtepi32_epi64(x));
+        sumHigh = _mm_add_epi64(sumHigh, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+    }
+    alignas(16) long long sums[2];
+    alignas(16) int mins[4], maxs[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums), _mm_add_epi64(sumLow, sumHigh));
+    _mm_store_si128(reinterpret_cast<__m128i*>(mins), min);
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxs), max);
+    return finish(n, sums[0] + sums[1], *std::min_element(mins, mins + 4), *std::max_element(maxs, maxs + 4),
+                  weights + i, n - i);
+}
+
+__attribute__((target("avx2"))) WeightSummary summarizeAvx2(const int* weights, std::size_t n) {
+    __m256i min = _mm256_set1_epi32(INT_MAX), max = _mm256_set1_epi32(INT_MIN);
+    __m256i sumLow = _mm256_setzero_si256(), sumHigh = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        min = _mm256_min_epi32(min, x);
+        max = _mm256_max_epi32(max, x);
+        sumLow = _mm256_add_epi64(sumLow, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        sumHigh = _mm256_add_epi64(sumHigh, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    alignas(32) long long sums[4];
+    alignas(32) int mins[8], maxs[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), _mm256_add_epi64(sumLow, sumHigh));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(mins), min);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), max);
+    return finish(n, sums[0] + sums[1] + sums[2] + sums[3], *std::min_element(mins, mins + 8),
+                  *std::max_element(maxs, maxs + 8), weights + i, n - i);
+}
+
+// Four edges per step: gather their weights, snapshot both components' current minima and
+// only CAS for the lanes whose key is smaller. Other workers are still CAS-ing into
+// cheapest[] during this scan, so the minima are read with relaxed atomic loads into a plain
+// array rather than gathered from it. A snapshot may be stale, which only lets through a
+// lane the CAS loop then rejects; a lane is never wrongly filtered out because minima only
+// decrease.
+__attribute__((target("avx2"))) void lowerCheapestAvx2(const int* weights, const std::uint32_t* origin,
+                                                        const int* eu, const int* ev, std::size_t lo,
+                                                        std::size_t hi, std::atomic<std::uint64_t>* cheapest) {
+    const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+    const __m256i flip = _mm256_set1_epi64x(LLONG_MIN);  // AVX2 only compares signed 64-bit ints
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    alignas(32) std::uint64_t keys[4], minU[4], minV[4];
+    std::size_t i = lo;
+    for (; i + 4 <= hi; i += 4) {
+        __m128i edges = _mm_loadu_si128(reinterpret_cast<const __m128i*>(origin + i));
+        __m128i weight = _mm_i32gather_epi32(weights, edges, 4);
+        __m256i biased = _mm256_cvtepu32_epi64(_mm_xor_si128(weight, bias));
+        __m256i key = _mm256_or_si256(_mm256_slli_epi64(biased, 32),
+                                      _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(i)), lanes));
+
+        for (int lane = 0; lane < 4; ++lane) {
+            minU[lane] = cheapest[eu[i + lane]].load(std::memory_order_relaxed);
+            minV[lane] = cheapest[ev[i + lane]].load(std::memory_order_relaxed);
+        }
+        __m256i atU = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(minU)), flip);
+        __m256i atV = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(minV)), flip);
+        __m256i flipped = _mm256_xor_si256(key, flip);
+        __m256i lowers = _mm256_or_si256(_mm256_cmpgt_epi64(atU, flipped), _mm256_cmpgt_epi64(atV, flipped));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(lowers));
+        if (mask == 0) continue;
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(keys), key);
+        for (; mask != 0; mask &= mask - 1) {
+            int lane = __builtin_ctz(static_cast<unsigned>(mask));
+            atomicMin(cheapest[eu[i + lane]], keys[lane]);
+            atomicMin(cheapest[ev[i + lane]], keys[lane]);
+        }
+    }
+    lowerCheapestScalar(weights, origin, eu, ev, i, hi, cheapest);
+}
+
+#endif  // SIMD_X86
+
+struct Kernels {
+    const char* name;
+    WeightSummary (*summarize)(const int*, std::size_t);
+    void (*lowerCheapest)(const int*, const std::uint32_t*, const int*, const int*, std::size_t, std::size_t,
+                          std::atomic<std::uint64_t>*);
+};
+
+const Kernels SCALAR = {"scalar", summarizeScalar, lowerCheapestScalar};
+#ifdef SIMD_X86
+// SSE4.1 has no gathers, so its cheapest-edge scan stays scalar
+const Kernels SSE4 = {"sse4", summarizeSse4, lowerCheapestScalar};
+const Kernels AVX2 = {"avx2", summarizeAvx2, lowerCheapestAvx2};
+#endif
+
+const Kernels* lookup(const char* name) {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (std::strcmp(name, "avx2") == 0) return __builtin_cpu_supports("avx2") ? &AVX2 : nullptr;
+    if (std::strcmp(name, "sse4") == 0) return __builtin_cpu_supports("sse4.1") ? &SSE4 : nullptr;
+#endif
+    return std::strcmp(name, "scalar") == 0 ? &SCALAR : nullptr;
+}
+
+const Kernels* best() {
+    const char* forced = std::getenv("MST_SIMD");
+    const Kernels* kernels = forced != nullptr ? lookup(forced) : nullptr;
+    if (kernels == nullptr) kernels = lookup("avx2");
+    if (kernels == nullptr) kernels = lookup("sse4");
+    return kernels != nullptr ? kernels : &SCALAR;
+}
+
+std::atomic<const Kernels*> current{nullptr};
+
+const Kernels& kernels() {
+    const Kernels* chosen = current.load(std::memory_order_acquire);
+    if (chosen == nullptr) {
+        chosen = best();  // Racing first calls all pick the same table
+        current.store(chosen, std::memory_order_release);
+    }
+    return *chosen;
+}
+
+}  // namespace
+
+WeightSummary summarize(const int* weights, std::size_t n) { return kernels().summarize(weights, n); }
+
+void lowerCheapest(const int* weights, const std::uint32_t* origin, const int* eu, const int* ev, std::size_t lo,
+                   std::size_t hi, std::atomic<std::uint64_t>* cheapest) {
+    kernels().lowerCheapest(weights, origin, eu, ev, lo, hi, cheapest);
+}
+
+const char* active() { return kernels().name; }
+
+bool select(const char* name) {
+    const Kernels* chosen = lookup(name);
+    if (chosen == nullptr) return false;
+    current.store(chosen, std::memory_order_release);
+    return true;
+}
+
+}  // namespace Simd
@@ -0,0 +1,47 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized scan kernels with a scalar fallback.
+// The weight reduction has AVX2, SSE4.1 and scalar forms; the cheapest-edge scan has AVX2 and
+// scalar ones, since SSE4.1 has no gathers. The best set the CPU supports is picked on first
+// use, so one binary runs everywhere. MST_SIMD=avx2|sse4|scalar in the environment,
+// or select(), forces a narrower one (never a wider one than the CPU has).
+namespace Simd {
+
+// Fused one-pass reduction of a weight array
+struct WeightSummary {
+    std::size_t count = 0;
+    long long sum = 0;
+    int min = 0;  // Both 0 for an empty array
+    int max = 0;
+};
+
+WeightSummary summarize(const int* weights, std::size_t n);
+
+// Borůvka's cheapest-edge scan over the edges [lo, hi) of a round: edge i joins components
+// eu[i] and ev[i] and has weight weights[origin[i]]. Its key, (biased weight << 32) | i, is
+// atomically min-ed into cheapest[] of both components. The vector forms gather the
+// weights for a batch of edges, load the components' current minima (atomically, as other
+// workers update them concurrently) and compare them first, so only edges that would
+// actually lower a minimum pay for a compare-and-swap.
+void lowerCheapest(const int* weights, const std::uint32_t* origin, const int* eu, const int* ev, std::size_t lo,
+                   std::size_t hi, std::atomic<std::uint64_t>* cheapest);
+
+inline std::uint64_t edgeKey(int weight, std::size_t pos) {
+    std::uint64_t biased = static_cast<std::uint32_t>(weight) ^ 0x80000000u;
+    return (biased << 32) | static_cast<std::uint32_t>(pos);
+}
+
+// The kernels in use: "avx2", "sse4" or "scalar"
+const char* active();
+
+// Switch to the named kernels; false if the name is unknown or the CPU lacks them
+bool select(const char* name);
+
+}  // namespace Simd
+
+#endif  // SIMD_KERNELS_HPP
@@ -0,0 +1,63 @@
+#include "spanning_forest.hpp"
+#include <algorithm>
+#include <numeric>
+#include "dsu.hpp"
+#include "parallel.hpp"
+
+std::size_t SpanningForest::edgeCount() const {
+    std::size_t count = 0;
+    for (const auto& tree : trees) count += tree.edges.size();
+    return count;
+}
+
+long long SpanningForest::totalWeight() const {
+    long long total = 0;
+    for (const auto& tree : trees) total += tree.stats.totalWeight;
+    return total;
+}
+
+std::vector<std::tuple<int, int, int>> SpanningForest::edges() const {
+    std::vector<std::tuple<int, int, int>> all;
+    all.reserve(edgeCount());
+    for (const auto& tree : trees) all.insert(all.end(), tree.edges.begin(), tree.edges.end());
+    return all;
+}
+
+std::vector<std::size_t> SpanningForest::largest(std::size_t limit) const {
+    std::vector<std::size_t> order(trees.size());
+    std::iota(order.begin(), order.end(), 0);
+    limit = std::min(limit, order.size());
+    // Trees are ordered by root, so the index breaks ties the same way
+    std::partial_sort(order.begin(), order.begin() + limit, order.end(), [this](std::size_t a, std::size_t b) {
+        return trees[a].vertices != trees[b].vertices ? trees[a].vertices > trees[b].vertices : a < b;
+    });
+    order.resize(limit);
+    return order;
+}
+
+int connectedComponents(const Graph& graph, std::vector<int>& component, unsigned numThreads,
+                        const CancelToken* cancel) {
+    const int V = graph.V;
+    const auto& edges = graph.getEdges();
+    const unsigned threads = resolveThreadCount(numThreads);
+    ConcurrentDSU dsu(V);
+    parallelChunks(edges.size(), chunkCount(edges.size(), threads), [&](unsigned, std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            if (CancelToken::poll(cancel, i - lo + 1)) return;
+            dsu.unite(std::get<1>(edges[i]), std::get<2>(edges[i]));
+        }
+    });
+    if (CancelToken::check(cancel)) return 0;
+
+    // Roots are the smallest vertex of their set, so numbering them in vertex order is dense
+    component.resize(V);
+    const unsigned vertexChunks = chunkCount(V, threads);
+    parallelChunks(V, vertexChunks, [&](unsigned, std::size_t lo, std::size_t hi) {
+        for (std::size_t v = lo; v < hi; ++v) component[v] = dsu.find(static_cast<int>(v));
+    });
+    int count = 0;
+    for (int v = 0; v < V; ++v) {
+        component[v] = component[v] == v ? count++ : component[component[v]];
+    }
+    return count;
+}
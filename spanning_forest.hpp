@@ -0,0 +1,39 @@
+#ifndef SPANNING_FOREST_HPP
+#define SPANNING_FOREST_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+#include "cancel_token.hpp"
+#include "graph.hpp"
+#include "mst_stats.hpp"
+
+// The minimum spanning tree of one connected component
+struct ComponentTree {
+    int root = 0;               // Smallest vertex of the component, which identifies it
+    int vertices = 0;
+    MSTStats stats;             // All zero for an isolated vertex
+    std::vector<std::tuple<int, int, int>> edges;  // (weight, u, v) in the graph's vertex ids
+};
+
+// Minimum spanning forest: one tree per connected component, isolated vertices included
+struct SpanningForest {
+    std::vector<ComponentTree> trees;  // Ordered by root
+    std::vector<int> component;        // Index into trees of every vertex's component
+
+    std::size_t edgeCount() const;
+    long long totalWeight() const;
+    // Every tree's edges in one list, as the single-tree algorithms return them
+    std::vector<std::tuple<int, int, int>> edges() const;
+    // Indices into trees of the (at most) limit largest trees by vertex count, largest first,
+    // ties broken by root
+    std::vector<std::size_t> largest(std::size_t limit) const;
+};
+
+// Label every vertex with its connected component, numbered 0..count-1 in order of the
+// components' smallest vertices, and return the count. The edges are united in parallel on
+// the shared pool through a ConcurrentDSU. A cancelled run returns 0 and partial labels.
+int connectedComponents(const Graph& graph, std::vector<int>& component, unsigned numThreads = 0,
+                        const CancelToken* cancel = nullptr);
+
+#endif  // SPANNING_FOREST_HPP
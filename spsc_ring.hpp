@@ -0,0 +1,71 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Capacity is rounded up to a power of two. tryPush fails when the ring is full, which is
+// how callers apply backpressure; tryPop fails when it is empty.
+template <typename T>
+class SpscRing {
+    static const std::size_t CACHE_LINE = 64;
+
+    std::vector<T> slots;
+    std::size_t mask;
+    alignas(CACHE_LINE) std::atomic<std::size_t> head{0};  // Next slot to pop, owned by the consumer
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail{0};  // Next slot to fill, owned by the producer
+    alignas(CACHE_LINE) std::size_t cachedHead = 0;        // Producer's last view of head
+    alignas(CACHE_LINE) std::size_t cachedTail = 0;        // Consumer's last view of tail
+
+    static std::size_t roundUp(std::size_t n) {
+        std::size_t size = 1;
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+public:
+    explicit SpscRing(std::size_t capacity) : slots(roundUp(capacity < 2 ? 2 : capacity)), mask(slots.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return slots.size(); }
+
+    // Approximate number of queued items, safe to read from any thread. head is loaded first:
+    // both only grow and head never passes tail, so the later tail is at least as large and
+    // the difference cannot wrap; a push racing between the loads is clamped off.
+    std::size_t size() const {
+        std::size_t h = head.load(std::memory_order_acquire);
+        std::size_t t = tail.load(std::memory_order_acquire);
+        return t - h < slots.size() ? t - h : slots.size();
+    }
+    bool empty() const { return size() == 0; }
+
+    bool tryPush(T&& item) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == slots.size()) return false;
+        }
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        out = std::move(slots[h & mask]);
+        slots[h & mask] = T();  // Release whatever the slot owned
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif  // SPSC_RING_HPP
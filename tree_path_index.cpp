@@ -0,0 +1,106 @@
+#include "tree_path_index.hpp"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+TreePathIndex::TreePathIndex(int V, const std::vector<std::tuple<int, int, int>>& treeEdges)
+    : V(V), depth(V, 0), treeId(V, -1), rootDistance(V, 0) {
+    if (V == 0) return;
+
+    // Tree adjacency in CSR form
+    std::vector<int> offsets(V + 1, 0);
+    for (const auto& edge : treeEdges) {
+        ++offsets[std::get<1>(edge) + 1];
+        ++offsets[std::get<2>(edge) + 1];
+    }
+    for (int x = 0; x < V; ++x) offsets[x + 1] += offsets[x];
+    std::vector<std::pair<int, int>> adj(offsets[V]);
+    std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto& edge : treeEdges) {
+        int weight, u, v;
+        std::tie(weight, u, v) = edge;
+        adj[cursor[u]++] = {v, weight};
+        adj[cursor[v]++] = {u, weight};
+    }
+
+    levels = 1;
+    while ((1 << levels) < V) ++levels;
+    up.assign(static_cast<std::size_t>(levels) * V, 0);
+    upMax.assign(static_cast<std::size_t>(levels) * V, std::numeric_limits<int>::min());
+    upMin.assign(static_cast<std::size_t>(levels) * V, std::numeric_limits<int>::max());
+
+    // Iterative BFS from every unvisited vertex; roots point at themselves
+    std::vector<int> queue;
+    queue.reserve(V);
+    for (int root = 0; root < V; ++root) {
+        if (treeId[root] != -1) continue;
+        treeId[root] = root;
+        up[root] = root;
+        queue.clear();
+        queue.push_back(root);
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            int x = queue[i];
+            for (int k = offsets[x]; k < offsets[x + 1]; ++k) {
+                int y = adj[k].first;
+                if (treeId[y] != -1) continue;
+                treeId[y] = root;
+                depth[y] = depth[x] + 1;
+                rootDistance[y] = rootDistance[x] + adj[k].second;
+                up[y] = x;
+                upMax[y] = adj[k].second;
+                upMin[y] = adj[k].second;
+                queue.push_back(y);
+            }
+        }
+    }
+
+    for (int k = 1; k < levels; ++k) {
+        const std::size_t cur = static_cast<std::size_t>(k) * V, prev = cur - V;
+        for (int x = 0; x < V; ++x) {
+            int mid = up[prev + x];
+            up[cur + x] = up[prev + mid];
+            upMax[cur + x] = std::max(upMax[prev + x], upMax[prev + mid]);
+            upMin[cur + x] = std::min(upMin[prev + x], upMin[prev + mid]);
+        }
+    }
+}
+
+TreePath TreePathIndex::query(int start, int end) const {
+    TreePath path;
+    if (start < 0 || end < 0 || start >= V || end >= V || treeId[start] != treeId[end]) return path;
+    path.connected = true;
+    if (start == end) return path;
+
+    int maxEdge = std::numeric_limits<int>::min();
+    int minEdge = std::numeric_limits<int>::max();
+    auto climb = [&](int& x, int k) {
+        const std::size_t at = static_cast<std::size_t>(k) * V + x;
+        maxEdge = std::max(maxEdge, upMax[at]);
+        minEdge = std::min(minEdge, upMin[at]);
+        x = up[at];
+    };
+
+    int a = start, b = end;
+    if (depth[a] < depth[b]) std::swap(a, b);
+    for (int k = levels - 1; k >= 0; --k) {
+        if (depth[a] - (1 << k) >= depth[b]) climb(a, k);
+    }
+    if (a != b) {
+        for (int k = levels - 1; k >= 0; --k) {
+            const std::size_t at = static_cast<std::size_t>(k) * V;
+            if (up[at + a] != up[at + b]) {
+                climb(a, k);
+                climb(b, k);
+            }
+        }
+        climb(a, 0);
+        climb(b, 0);
+    }
+
+    int lca = a;
+    path.length = rootDistance[start] + rootDistance[end] - 2 * rootDistance[lca];
+    path.edgeCount = depth[start] + depth[end] - 2 * depth[lca];
+    path.maxEdge = maxEdge;
+    path.minEdge = minEdge;
+    return path;
+}
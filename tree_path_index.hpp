@@ -0,0 +1,39 @@
+#ifndef TREE_PATH_INDEX_HPP
+#define TREE_PATH_INDEX_HPP
+
+#include <vector>
+#include <tuple>
+#include <cstdint>
+
+// Summary of the unique tree path between two vertices
+struct TreePath {
+    bool connected = false;  // False when the endpoints lie in different trees
+    long long length = 0;    // Sum of edge weights
+    int maxEdge = 0;         // Heaviest edge on the path (0 for an empty path)
+    int minEdge = 0;         // Lightest edge on the path (0 for an empty path)
+    int edgeCount = 0;
+};
+
+// Binary-lifting LCA index over a spanning forest. Built once per MST in O(V log V),
+// it answers path length, max-edge and min-edge queries in O(log V).
+class TreePathIndex {
+public:
+    TreePathIndex() = default;
+    TreePathIndex(int V, const std::vector<std::tuple<int, int, int>>& treeEdges);
+
+    bool empty() const { return V == 0; }
+    TreePath query(int start, int end) const;
+
+private:
+    int V = 0;
+    int levels = 0;
+    std::vector<int> depth;
+    std::vector<int> treeId;            // Root of the tree each vertex belongs to
+    std::vector<long long> rootDistance;
+    // Level k entry for vertex x lives at [k * V + x]
+    std::vector<int> up;                // 2^k-th ancestor
+    std::vector<int> upMax;             // Heaviest edge over those 2^k steps
+    std::vector<int> upMin;             // Lightest edge over those 2^k steps
+};
+
+#endif  // TREE_PATH_INDEX_HPP
@@ -0,0 +1,165 @@
+#include "work_stealing_pool.hpp"
+#include <chrono>
+
+namespace {
+
+// Polls of every queue an idle worker makes before it goes to sleep
+const int IDLE_POLLS = 64;
+
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local void* currentSlot = nullptr;
+
+std::uint64_t nextRandom(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned numWorkers) {
+    unsigned count = numWorkers;
+    if (count == 0) count = std::thread::hardware_concurrency();
+    if (count == 0) count = 1;
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        workers.emplace_back(new Worker());
+        workers.back()->seed = i + 1;
+    }
+    // Start the threads only once every deque exists, since they steal from each other
+    for (auto& worker : workers) {
+        Worker* self = worker.get();
+        self->thread = std::thread([this, self]() { run(*self); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+        stopping.store(true);
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) worker->thread.join();
+}
+
+WorkStealingPool& WorkStealingPool::shared() {
+    static WorkStealingPool* instance = new WorkStealingPool();  // Never destroyed: used until exit
+    return *instance;
+}
+
+WorkStealingPool::Worker* WorkStealingPool::currentWorker() const {
+    return currentPool == this ? static_cast<Worker*>(currentSlot) : nullptr;
+}
+
+void WorkStealingPool::submit(Task task) {
+    Worker* self = currentWorker();
+    if (self != nullptr) {
+        std::lock_guard<std::mutex> lock(self->mtx);
+        self->tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injectMtx);
+        injected.push_back(std::move(task));
+    }
+    // Pairs with the sleeper registering before it checks `queued` (both sequentially
+    // consistent), so either the sleeper sees the task or we see the sleeper
+    queued.fetch_add(1);
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+        wakeup.notify_one();
+    }
+}
+
+bool WorkStealingPool::popLocal(Worker& worker, Task& task) {
+    std::lock_guard<std::mutex> lock(worker.mtx);
+    if (worker.tasks.empty()) return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::popInjected(Task& task) {
+    std::lock_guard<std::mutex> lock(injectMtx);
+    if (injected.empty()) return false;
+    task = std::move(injected.front());
+    injected.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(std::uint64_t& seed, const Worker* self, Task& task) {
+    std::size_t count = workers.size();
+    std::size_t start = static_cast<std::size_t>(nextRandom(seed) % count);
+    for (std::size_t i = 0; i < count; ++i) {
+        Worker& victim = *workers[(start + i) % count];
+        if (&victim == self) continue;
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::findTask(Worker* self, std::uint64_t& seed, Task& task) {
+    if (queued.load(std::memory_order_relaxed) == 0) return false;
+    bool found = (self != nullptr && popLocal(*self, task)) || popInjected(task) || steal(seed, self, task);
+    if (found) queued.fetch_sub(1);
+    return found;
+}
+
+void WorkStealingPool::run(Worker& self) {
+    currentPool = this;
+    currentSlot = &self;
+    Task task;
+    int idlePolls = 0;
+    while (true) {
+        if (findTask(&self, self.seed, task)) {
+            idlePolls = 0;
+            task();
+            task = nullptr;
+            continue;
+        }
+        if (stopping.load()) return;
+        if (++idlePolls < IDLE_POLLS) {
+            std::this_thread::yield();
+            continue;
+        }
+        idlePolls = 0;
+        std::unique_lock<std::mutex> lock(sleepMtx);
+        sleepers.fetch_add(1);
+        wakeup.wait(lock, [this]() { return queued.load() > 0 || stopping.load(); });
+        sleepers.fetch_sub(1);
+    }
+}
+
+void TaskGroup::finish() {
+    // Decrement under the lock: a waiter that sees zero takes the lock before returning, so
+    // the group cannot be destroyed while this thread still touches it
+    std::lock_guard<std::mutex> lock(mtx);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) done.notify_all();
+}
+
+bool TaskGroup::Backlog::runNext() {
+    WorkStealingPool::Task task;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (tasks.empty()) return false;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+    }
+    task();
+    return true;
+}
+
+void TaskGroup::wait() {
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (backlog->runNext()) continue;
+        // Nothing left to help with: our tasks are running elsewhere. Wake up now and then in
+        // case they add more tasks to this group.
+        std::unique_lock<std::mutex> lock(mtx);
+        done.wait_for(lock, std::chrono::microseconds(200),
+                      [this]() { return pending.load(std::memory_order_acquire) == 0; });
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+}
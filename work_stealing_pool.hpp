@@ -0,0 +1,120 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "inline_task.hpp"
+
+// Fork/join thread pool shared by everything that splits work across cores.
+// Every worker owns a deque: it pushes and pops its own tasks at the back (newest first, so
+// nested forks stay cache-warm) while idle workers steal from the front of a randomly chosen
+// victim (oldest first, i.e. the biggest remaining pieces). Threads outside the pool submit
+// into a shared queue. Idle workers sleep on a condition variable and are only woken when
+// there is work and somebody is asleep, so a quiet pool costs nothing.
+// Waiting for a TaskGroup runs the group's own tasks that no worker has started yet instead
+// of blocking, so nested fork/join cannot deadlock and a thread waiting on a large job helps
+// it finish, but never picks up somebody else's work (a background job's, say) in between.
+class WorkStealingPool {
+public:
+    static const std::size_t TASK_CAPACITY = 48;
+    using Task = InlineTask<TASK_CAPACITY>;
+
+    // 0 workers means one per hardware thread
+    explicit WorkStealingPool(unsigned numWorkers = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // The process-wide pool, sized to the hardware and started on first use
+    static WorkStealingPool& shared();
+
+    unsigned workerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    void submit(Task task);
+
+private:
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+        std::uint64_t seed;  // Victim selection, only touched by the worker itself
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex injectMtx;
+    std::deque<Task> injected;  // Submitted from outside the pool
+
+    std::atomic<std::size_t> queued{0};  // Tasks waiting in any queue
+    std::atomic<unsigned> sleepers{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMtx;
+    std::condition_variable wakeup;
+
+    Worker* currentWorker() const;
+    bool popLocal(Worker& worker, Task& task);
+    bool popInjected(Task& task);
+    bool steal(std::uint64_t& seed, const Worker* self, Task& task);
+    bool findTask(Worker* self, std::uint64_t& seed, Task& task);
+    void run(Worker& self);
+};
+
+// A set of forked tasks to join. wait() returns once every task run() so far has finished,
+// and the destructor waits too, so tasks may safely reference the caller's stack.
+// The tasks themselves stay in the group's backlog; the pool only gets a ticket per task that
+// runs the oldest one still waiting there. The waiting thread takes from the same backlog,
+// so it runs its own tasks, and a ticket that finds the backlog empty does nothing. Tickets
+// share the backlog, so one that a worker reaches after the group is gone stays harmless.
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool = WorkStealingPool::shared())
+        : pool(pool), backlog(std::make_shared<Backlog>()) {}
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename Fn>
+    void run(Fn&& fn) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(backlog->mtx);
+            backlog->tasks.emplace_back([this, fn = std::forward<Fn>(fn)]() mutable {
+                {
+                    auto body = std::move(fn);  // Destroyed before the group may go away
+                    body();
+                }
+                finish();
+            });
+        }
+        pool.submit([backlog = backlog]() { backlog->runNext(); });
+    }
+
+    void wait();
+
+private:
+    struct Backlog {
+        std::mutex mtx;
+        std::deque<WorkStealingPool::Task> tasks;  // Not started yet, oldest first
+
+        bool runNext();  // False if nothing was waiting
+    };
+
+    WorkStealingPool& pool;
+    std::shared_ptr<Backlog> backlog;
+    std::atomic<std::size_t> pending{0};
+    std::mutex mtx;
+    std::condition_variable done;
+
+    void finish();
+};
+
+#endif  // WORK_STEALING_POOL_HPP